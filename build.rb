@@ -10,12 +10,14 @@ module Opts
   TEST = :test
   COVERAGE = :coverage
   RUN = :run
+  BENCH = :bench
   ALL = :all
 end
 
 PROJECT_ROOT = "#{__dir__}".freeze
 PROJECT_NAME = File.basename(PROJECT_ROOT).freeze
 PROJECT_NAME_TEST = "#{PROJECT_NAME}Test".freeze
+PROJECT_NAME_BENCH = "#{PROJECT_NAME}Bench".freeze
 BUILD_DIR = "#{PROJECT_ROOT}/build".freeze
 
 CORES = `nproc`.strip.to_i.freeze
@@ -51,6 +53,10 @@ OptionParser.new do |opts|
     options[Opts::RUN] = true
   end
 
+  opts.on('--bench', 'run the compiler benchmark') do |_|
+    options[Opts::BENCH] = true
+  end
+
   opts.on('-a', '--all', 'build, test, generate code coverage in that order') do |_|
     options[Opts::ALL] = true
   end
@@ -113,3 +119,9 @@ if options[Opts::RUN]
     exit_if_fail("#{PROJECT_NAME} #{ARGV.join(' ')}")
   end
 end
+
+if options[Opts::BENCH]
+  do_in_dir(BUILD_DIR) do
+    exit_if_fail("#{PROJECT_NAME_BENCH} #{ARGV.join(' ')}")
+  end
+end
@@ -0,0 +1,157 @@
+#include "generate.hpp"
+
+#include <type_traits>
+
+namespace ss
+{
+  namespace bench
+  {
+    namespace
+    {
+      /**
+       * @brief Appends the pieces to the script, numbers formatted in decimal
+       */
+      template <typename... Parts>
+      void write(std::string& out, const Parts&... parts)
+      {
+        auto append = [&out](const auto& part) {
+          if constexpr (std::is_integral_v<std::decay_t<decltype(part)>>) {
+            out += std::to_string(part);
+          } else {
+            out += part;
+          }
+        };
+        (append(parts), ...);
+      }
+
+      void indent(std::string& out, std::size_t level)
+      {
+        out.append(level * 2, ' ');
+      }
+
+      void nested_function(std::string& out, std::size_t unit, std::size_t level, std::size_t depth)
+      {
+        indent(out, level);
+        write(out, "fn f", unit, "_", level, "(x) {\n");
+        if (level + 1 < depth) {
+          nested_function(out, unit, level + 1, depth);
+          indent(out, level + 1);
+          write(out, "ret f", unit, "_", level + 1, "(x) + 1;\n");
+        } else {
+          indent(out, level + 1);
+          write(out, "ret x + ", level, ";\n");
+        }
+        indent(out, level);
+        write(out, "}\n");
+      }
+
+      auto nested_functions(std::size_t size, std::size_t depth) -> std::string
+      {
+        std::string out;
+        for (std::size_t unit = 0; unit < size; unit++) {
+          nested_function(out, unit, 0, depth);
+          write(out, "f", unit, "_0(", unit, ");\n");
+        }
+        return out;
+      }
+
+      auto expression_chain(std::size_t size, std::size_t depth) -> std::string
+      {
+        static constexpr const char* OPERATORS[] = {" + ", " * ", " - ", " / ", " % "};
+
+        std::string out = "let e0 = 1;\n";
+        for (std::size_t unit = 1; unit <= size; unit++) {
+          write(out, "let e", unit, " = e", unit - 1);
+          for (std::size_t term = 0; term < depth; term++) {
+            write(out, OPERATORS[term % std::size(OPERATORS)]);
+            // grouping every few terms keeps the values small and walks the grouping rule as well
+            if (term % 4 == 3) {
+              write(out, "(", term + 1, " + e0)");
+            } else {
+              write(out, term + 1);
+            }
+          }
+          write(out, ";\n");
+        }
+        return out;
+      }
+
+      auto match_block(std::size_t size) -> std::string
+      {
+        std::string out;
+        write(out, "let m = ", size / 2, ";\nlet hits = 0;\nmatch m {\n");
+        for (std::size_t arm = 0; arm < size; arm++) {
+          write(out, "  ", arm, " => {\n    hits = hits + ", arm, ";\n  }\n");
+        }
+        write(out, "}\n");
+        return out;
+      }
+
+      auto literal_table(std::size_t size) -> std::string
+      {
+        std::string out;
+        for (std::size_t unit = 0; unit < size; unit++) {
+          if (unit % 2 == 0) {
+            write(out, "let t", unit, " = ", unit, ".", unit % 97, ";\n");
+          } else {
+            write(out, "let t", unit, " = \"literal number ", unit, "\";\n");
+          }
+        }
+        return out;
+      }
+    }  // namespace
+
+    auto to_string(Shape shape) noexcept -> const char*
+    {
+      switch (shape) {
+        case Shape::NESTED_FUNCTIONS: {
+          return "nested_functions";
+        }
+        case Shape::EXPRESSION_CHAIN: {
+          return "expression_chain";
+        }
+        case Shape::MATCH_BLOCK: {
+          return "match_block";
+        }
+        case Shape::LITERAL_TABLE: {
+          return "literal_table";
+        }
+        default: {
+          return "?";
+        }
+      }
+    }
+
+    auto shape_from_string(std::string_view name) noexcept -> std::optional<Shape>
+    {
+      for (std::size_t i = 0; i < static_cast<std::size_t>(Shape::LAST); i++) {
+        auto shape = static_cast<Shape>(i);
+        if (name == to_string(shape)) {
+          return shape;
+        }
+      }
+      return std::nullopt;
+    }
+
+    auto generate(Shape shape, std::size_t size, std::size_t depth) -> std::string
+    {
+      switch (shape) {
+        case Shape::NESTED_FUNCTIONS: {
+          return nested_functions(size, depth);
+        }
+        case Shape::EXPRESSION_CHAIN: {
+          return expression_chain(size, depth);
+        }
+        case Shape::MATCH_BLOCK: {
+          return match_block(size);
+        }
+        case Shape::LITERAL_TABLE: {
+          return literal_table(size);
+        }
+        default: {
+          return std::string();
+        }
+      }
+    }
+  }  // namespace bench
+}  // namespace ss
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace ss
+{
+  namespace bench
+  {
+    /**
+     * @brief Kinds of synthetic scripts, each one stresses a different part of the compiler
+     */
+    enum class Shape
+    {
+      /**
+       * @brief Functions declared inside functions, deepening the local and call frame bookkeeping
+       */
+      NESTED_FUNCTIONS,
+      /**
+       * @brief Declarations initialized by long binary expressions, exercising the Pratt parser
+       */
+      EXPRESSION_CHAIN,
+      /**
+       * @brief A single match statement with an arm per unit of size
+       */
+      MATCH_BLOCK,
+      /**
+       * @brief Globals initialized with number and string literals, filling the constant and intern tables
+       */
+      LITERAL_TABLE,
+      LAST,
+    };
+
+    auto to_string(Shape shape) noexcept -> const char*;
+
+    /**
+     * @brief The shape with the name to_string gives it
+     */
+    auto shape_from_string(std::string_view name) noexcept -> std::optional<Shape>;
+
+    /**
+     * @brief Generates a script that compiles and runs without errors
+     *
+     * @param size How many units the script has, functions, declarations, arms or literals depending on the shape
+     * @param depth How deeply functions nest, or how many terms an expression has
+     */
+    auto generate(Shape shape, std::size_t size, std::size_t depth) -> std::string;
+  }  // namespace bench
+}  // namespace ss
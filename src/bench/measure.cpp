@@ -0,0 +1,139 @@
+#include "measure.hpp"
+
+#include "ss/code.hpp"
+#include "ss/memory.hpp"
+#include "ss/util.hpp"
+
+#include <algorithm>
+
+namespace ss
+{
+  namespace bench
+  {
+    namespace
+    {
+      using Clock = std::chrono::steady_clock;
+
+      auto per_second(std::size_t count, std::chrono::nanoseconds time) noexcept -> double
+      {
+        if (time.count() == 0) {
+          return 0.0;
+        }
+        return static_cast<double>(count) / std::chrono::duration<double>(time).count();
+      }
+
+      /**
+       * @brief Keeps the fastest time and the largest footprint of the runs
+       */
+      void record(PhaseStats& stats, std::chrono::nanoseconds time, std::size_t memory, bool first)
+      {
+        stats.time        = first ? time : std::min(stats.time, time);
+        stats.peak_memory = std::max(stats.peak_memory, memory);
+      }
+
+      auto code_bytes(const BytecodeChunk& chunk) noexcept -> std::size_t
+      {
+        return chunk.instruction_count() * sizeof(Instruction);
+      }
+
+      auto measure_scan(const std::string& source, std::size_t repeat) -> PhaseStats
+      {
+        PhaseStats stats{.phase = "scan", .source_bytes = source.size()};
+
+        for (std::size_t i = 0; i < repeat; i++) {
+          util::Arena arena;
+          std::string text = source;
+          Scanner scanner(std::move(text), &arena);
+
+          auto start  = Clock::now();
+          auto tokens = scanner.scan();
+          auto time   = Clock::now() - start;
+
+          stats.tokens = tokens.size();
+          record(stats, time, arena.allocated(), i == 0);
+        }
+
+        return stats;
+      }
+
+      auto measure_parse(const std::string& source, std::size_t repeat) -> PhaseStats
+      {
+        PhaseStats stats{.phase = "parse", .source_bytes = source.size()};
+
+        for (std::size_t i = 0; i < repeat; i++) {
+          MemoryTracker tracker;
+          MemoryTracker::Scope memory_scope(tracker);
+          BytecodeChunk chunk;
+
+          util::Arena arena;
+          std::string text = source;
+          Scanner scanner(std::move(text), &arena);
+          auto tokens       = scanner.scan();
+          std::size_t count = tokens.size();
+
+          auto start = Clock::now();
+          {
+            Parser parser(std::move(tokens), chunk, "bench");
+            parser.parse();
+          }
+          auto time = Clock::now() - start;
+
+          stats.tokens       = count;
+          stats.instructions = chunk.instruction_count();
+          record(stats, time, arena.allocated() + tracker.peak() + code_bytes(chunk), i == 0);
+        }
+
+        return stats;
+      }
+
+      auto measure_compile(const std::string& source, std::size_t repeat, bool lazy, std::size_t tokens) -> PhaseStats
+      {
+        PhaseStats stats{.phase = lazy ? "compile (lazy)" : "compile", .source_bytes = source.size(), .tokens = tokens};
+
+        for (std::size_t i = 0; i < repeat; i++) {
+          MemoryTracker tracker;
+          MemoryTracker::Scope memory_scope(tracker);
+          BytecodeChunk chunk;
+
+          // the same steps as Compiler::compile, with the arena in reach for its size
+          std::string text = source;
+          auto start       = Clock::now();
+          util::Arena arena;
+          {
+            Scanner scanner(std::move(text), &arena);
+            Parser parser(scanner, chunk, "bench", lazy);
+            parser.parse();
+          }
+          auto time = Clock::now() - start;
+
+          stats.instructions = chunk.instruction_count();
+          record(stats, time, arena.allocated() + tracker.peak() + code_bytes(chunk), i == 0);
+        }
+
+        return stats;
+      }
+    }  // namespace
+
+    auto PhaseStats::tokens_per_second() const noexcept -> double
+    {
+      return per_second(this->tokens, this->time);
+    }
+
+    auto PhaseStats::bytes_per_second() const noexcept -> double
+    {
+      return per_second(this->source_bytes, this->time);
+    }
+
+    auto measure(const std::string& source, std::size_t repeat) -> std::vector<PhaseStats>
+    {
+      repeat = std::max<std::size_t>(repeat, 1);
+
+      std::vector<PhaseStats> phases;
+      phases.push_back(measure_scan(source, repeat));
+      phases.push_back(measure_parse(source, repeat));
+      phases.push_back(measure_compile(source, repeat, false, phases.front().tokens));
+      phases.push_back(measure_compile(source, repeat, true, phases.front().tokens));
+      return phases;
+    }
+  }  // namespace bench
+}  // namespace ss
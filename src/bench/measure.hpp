@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ss
+{
+  namespace bench
+  {
+    /**
+     * @brief What one phase of compilation took on one source, timings are the fastest of the repeats
+     */
+    struct PhaseStats
+    {
+      const char* phase;
+      std::chrono::nanoseconds time{0};
+      std::size_t source_bytes = 0;
+      std::size_t tokens       = 0;
+      std::size_t instructions = 0;
+      /**
+       * @brief Most memory held at once, the arena for tokens and parser state plus what the chunk was charged for
+       */
+      std::size_t peak_memory = 0;
+
+      auto tokens_per_second() const noexcept -> double;
+      auto bytes_per_second() const noexcept -> double;
+    };
+
+    /**
+     * @brief Measures scanning to a token list, parsing that list, then the whole of Compiler::compile both eagerly and with
+     * lazy function bodies
+     *
+     * @param repeat How many times each phase runs
+     */
+    auto measure(const std::string& source, std::size_t repeat) -> std::vector<PhaseStats>;
+  }  // namespace bench
+}  // namespace ss
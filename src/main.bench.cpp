@@ -0,0 +1,103 @@
+#include "bench/generate.hpp"
+#include "bench/measure.hpp"
+#include "ss/exceptions.hpp"
+
+#include <charconv>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  constexpr std::size_t DEFAULT_SIZE   = 1000;
+  constexpr std::size_t DEFAULT_DEPTH  = 16;
+  constexpr std::size_t DEFAULT_REPEAT = 5;
+
+  void usage(const char* program)
+  {
+    std::cerr << "usage: " << program << " [--shape <name>]... [--size <n>] [--depth <n>] [--repeat <n>]\n"
+              << "shapes:";
+    for (std::size_t i = 0; i < static_cast<std::size_t>(ss::bench::Shape::LAST); i++) {
+      std::cerr << ' ' << ss::bench::to_string(static_cast<ss::bench::Shape>(i));
+    }
+    std::cerr << '\n';
+  }
+
+  auto parse_count(std::string_view arg, std::size_t& out) -> bool
+  {
+    auto [end, err] = std::from_chars(arg.data(), arg.data() + arg.size(), out);
+    return err == std::errc() && end == arg.data() + arg.size();
+  }
+
+  void report(ss::bench::Shape shape, const std::string& source, const std::vector<ss::bench::PhaseStats>& phases)
+  {
+    std::cout << ss::bench::to_string(shape) << ": " << source.size() << " bytes\n";
+    std::cout << std::left << std::setw(16) << "  phase" << std::right << std::setw(12) << "ms" << std::setw(16)
+              << "tokens/s" << std::setw(12) << "MB/s" << std::setw(14) << "instructions" << std::setw(12) << "peak KB"
+              << '\n';
+    for (const auto& phase : phases) {
+      std::cout << std::left << std::setw(16) << ("  " + std::string(phase.phase)) << std::right << std::fixed
+                << std::setprecision(3) << std::setw(12) << std::chrono::duration<double, std::milli>(phase.time).count()
+                << std::setprecision(0) << std::setw(16) << phase.tokens_per_second() << std::setprecision(2)
+                << std::setw(12) << phase.bytes_per_second() / (1024.0 * 1024.0) << std::setw(14) << phase.instructions
+                << std::setw(12) << phase.peak_memory / 1024 << '\n';
+    }
+  }
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  std::vector<ss::bench::Shape> shapes;
+  std::size_t size   = DEFAULT_SIZE;
+  std::size_t depth  = DEFAULT_DEPTH;
+  std::size_t repeat = DEFAULT_REPEAT;
+
+  for (int i = 1; i < argc; i++) {
+    std::string_view option = argv[i];
+    if (i + 1 >= argc) {
+      usage(argv[0]);
+      return 1;
+    }
+    std::string_view arg = argv[++i];
+
+    bool ok = true;
+    if (option == "--shape") {
+      auto shape = ss::bench::shape_from_string(arg);
+      ok         = shape.has_value();
+      if (ok) {
+        shapes.push_back(*shape);
+      }
+    } else if (option == "--size") {
+      ok = parse_count(arg, size);
+    } else if (option == "--depth") {
+      ok = parse_count(arg, depth) && depth > 0;
+    } else if (option == "--repeat") {
+      ok = parse_count(arg, repeat);
+    } else {
+      ok = false;
+    }
+
+    if (!ok) {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (shapes.empty()) {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(ss::bench::Shape::LAST); i++) {
+      shapes.push_back(static_cast<ss::bench::Shape>(i));
+    }
+  }
+
+  try {
+    for (auto shape : shapes) {
+      std::string source = ss::bench::generate(shape, size, depth);
+      report(shape, source, ss::bench::measure(source, repeat));
+    }
+  } catch (ss::CompiletimeError& e) {
+    std::cerr << "compile error: " << e.what() << '\n';
+    return 1;
+  }
+
+  return 0;
+}
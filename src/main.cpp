@@ -1,7 +1,11 @@
+#include "ss/bytecode.hpp"
 #include "ss/exceptions.hpp"
 #include "ss/vm.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <string_view>
+#include <thread>
 
 int main(int argc, char* argv[])
 {
@@ -10,35 +14,80 @@ int main(int argc, char* argv[])
   using ss::RuntimeError;
   using ss::Value;
   using ss::VM;
+  using ss::VMConfig;
   using Args = ss::NativeFunction::Args;
 
-  VM vm;
+  auto backend        = VMConfig::Backend::STACK;
+  bool lazy_functions = false;
+  std::size_t threads = 0;
+  bool compile_stats  = false;
+  bool compile_only   = false;
+  for (; argc > 1; argc--, argv++) {
+    std::string_view option = argv[1];
+    if (option == "--register") {
+      backend = VMConfig::Backend::REGISTER;
+    } else if (option == "--lazy") {
+      lazy_functions = true;
+    } else if (option == "--parallel-loads") {
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+    } else if (option == "--compile-stats") {
+      compile_stats = true;
+    } else if (option == "--compile") {
+      compile_only = true;
+    } else {
+      break;
+    }
+  }
+
+  VM vm(VMConfig()
+         .set_backend(backend)
+         .set_lazy_functions(lazy_functions)
+         .set_module_threads(threads)
+         .set_compile_stats(compile_stats));
 
-  vm.set_var("clock", Value(std::make_shared<NativeFunction>("clock", 0, [](Args&&) {
+  vm.set_var("clock", Value(ss::make_ref<NativeFunction>("clock", 0, [](Args&&) {
                auto tp                                       = std::chrono::high_resolution_clock::now();
                std::chrono::duration<Value::NumberType> secs = tp.time_since_epoch();
                return Value(Value::NumberType{secs.count()});
              })));
 
+  if (compile_only) {
+    int status = 0;
+    for (; argc > 1; argc--, argv++) {
+      try {
+        ss::bytecode::compile_file(argv[1], ss::bytecode::compiled_path(argv[1]));
+      } catch (CompiletimeError& e) {
+        std::cout << "compile error: " << e.what() << '\n';
+        status = 1;
+      }
+    }
+    return status;
+  }
+
   if (argc > 1) {
+    int status = 0;
     try {
       auto ret = vm.run_file(argv[1]);
-      if (ret.is_type(ss::Value::Type::Number)) {
+      if (ret.is_numeric()) {
         std::cout << "got " << ret << '\n';
-        return static_cast<int>(ret.number());
-      } else {
-        return 0;
+        status = static_cast<int>(ret.number());
       }
     } catch (CompiletimeError& e) {
       std::cout << "compile error: " << e.what() << '\n';
-      return 1;
+      status = 1;
     } catch (RuntimeError& e) {
       std::cout << "runtime error: " << e.what() << '\n';
-      return 1;
+      status = 1;
     } catch (std::exception& e) {
       std::cout << "exception: " << e.what() << '\n';
-      return 1;
+      status = 1;
     }
+
+    if (compile_stats) {
+      std::cerr << vm.compile_stats();
+    }
+
+    return status;
   } else {
     return vm.repl();
   }
@@ -0,0 +1,97 @@
+#include "builtins.hpp"
+
+#include "exceptions.hpp"
+
+#include <string_view>
+
+namespace ss
+{
+  namespace builtins
+  {
+    namespace
+    {
+      auto string_arg(const char* fn, const NativeFunction::Args& args, std::size_t i) -> Value::StringObjectType
+      {
+        if (!args[i].is_type(Value::Type::String)) {
+          RuntimeError::throw_err(fn, ": expected a string for argument ", i + 1, ", got ", args[i]);
+        }
+        return args[i].string_object();
+      }
+
+      auto index_arg(const char* fn, const NativeFunction::Args& args, std::size_t i) -> std::size_t
+      {
+        if (!args[i].is_type(Value::Type::Int)) {
+          RuntimeError::throw_err(fn, ": expected an integer for argument ", i + 1, ", got ", args[i]);
+        }
+        auto index = args[i].integer_unchecked();
+        if (index < 0) {
+          RuntimeError::throw_err(fn, ": argument ", i + 1, " must not be negative, got ", index);
+        }
+        return static_cast<std::size_t>(index);
+      }
+
+      auto is_space(char c) noexcept -> bool
+      {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+      }
+    }  // namespace
+
+    auto substr(NativeFunction::Args&& args) -> Value
+    {
+      auto str    = string_arg("substr", args, 0);
+      auto start  = index_arg("substr", args, 1);
+      auto length = index_arg("substr", args, 2);
+      return Value(String::slice(str, start, length));
+    }
+
+    auto split(NativeFunction::Args&& args) -> Value
+    {
+      auto str       = string_arg("split", args, 0);
+      auto separator = string_arg("split", args, 1)->view();
+      auto index     = index_arg("split", args, 2);
+
+      if (separator.empty()) {
+        RuntimeError::throw_err("split: separator must not be empty");
+      }
+
+      auto chars        = str->view();
+      std::size_t begin = 0;
+      for (std::size_t field = 0; field < index; field++) {
+        auto found = chars.find(separator, begin);
+        if (found == std::string_view::npos) {
+          return Value();
+        }
+        begin = found + separator.size();
+      }
+
+      auto end = chars.find(separator, begin);
+      if (end == std::string_view::npos) {
+        end = chars.size();
+      }
+
+      return Value(String::slice(str, begin, end - begin));
+    }
+
+    auto trim(NativeFunction::Args&& args) -> Value
+    {
+      auto str   = string_arg("trim", args, 0);
+      auto chars = str->view();
+
+      std::size_t begin = 0;
+      std::size_t end   = chars.size();
+      while (begin < end && is_space(chars[begin])) { begin++; }
+      while (end > begin && is_space(chars[end - 1])) { end--; }
+
+      return Value(String::slice(str, begin, end - begin));
+    }
+
+    auto all() -> std::vector<Value::NativeFunctionType>
+    {
+      return {
+       make_ref<NativeFunction>("substr", 3, substr),
+       make_ref<NativeFunction>("split", 3, split),
+       make_ref<NativeFunction>("trim", 1, trim),
+      };
+    }
+  }  // namespace builtins
+}  // namespace ss
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "datatypes.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace ss
+{
+  namespace builtins
+  {
+    /**
+     * @brief substr(str, start, length), the characters of str in the given range, clamped to the string
+     */
+    auto substr(NativeFunction::Args&& args) -> Value;
+
+    /**
+     * @brief split(str, separator, index), the index-th field of str when cut at each separator, nil past the last one
+     */
+    auto split(NativeFunction::Args&& args) -> Value;
+
+    /**
+     * @brief trim(str), str without leading and trailing whitespace
+     */
+    auto trim(NativeFunction::Args&& args) -> Value;
+
+    /**
+     * @brief Every builtin, ready to be defined as a global. None of them copy characters, their results are slices of
+     * the argument
+     */
+    auto all() -> std::vector<Value::NativeFunctionType>;
+  }  // namespace builtins
+}  // namespace ss
@@ -0,0 +1,515 @@
+#include "bytecode.hpp"
+
+#include "exceptions.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <utility>
+
+namespace ss
+{
+  namespace bytecode
+  {
+    namespace
+    {
+      constexpr std::array<char, 4> MAGIC = {'S', 'S', 'C', '\0'};
+
+      enum class ConstantTag : std::uint8_t
+      {
+        NIL,
+        BOOL,
+        NUMBER,
+        INT,
+        STRING,
+        INTERNED_STRING,
+        FUNCTION,
+        /**
+         * @brief A function whose body is compiled on its first call, stored as its source
+         */
+        LAZY_FUNCTION,
+        ADDRESS,
+      };
+
+      class Writer
+      {
+       public:
+        explicit Writer(std::ostream& o) noexcept
+         : out(o)
+        {}
+
+        void u8(std::uint8_t value)
+        {
+          this->out.put(static_cast<char>(value));
+        }
+
+        void u32(std::uint32_t value)
+        {
+          this->uint(value, sizeof(value));
+        }
+
+        void u64(std::uint64_t value)
+        {
+          this->uint(value, sizeof(value));
+        }
+
+        void string(std::string_view str)
+        {
+          this->u64(str.size());
+          this->out.write(str.data(), static_cast<std::streamsize>(str.size()));
+        }
+
+        void names(const BytecodeChunk::GlobalNameSet& names)
+        {
+          this->u64(names.size());
+          for (const auto& name : names) { this->string(name); }
+        }
+
+       private:
+        std::ostream& out;
+
+        void uint(std::uint64_t value, std::size_t bytes)
+        {
+          for (std::size_t i = 0; i < bytes; i++) { this->u8(static_cast<std::uint8_t>(value >> (i * 8))); }
+        }
+      };
+
+      class Reader
+      {
+       public:
+        explicit Reader(std::istream& i) noexcept
+         : in(i)
+        {}
+
+        auto u8() -> std::uint8_t
+        {
+          return static_cast<std::uint8_t>(this->uint(1));
+        }
+
+        auto u32() -> std::uint32_t
+        {
+          return static_cast<std::uint32_t>(this->uint(sizeof(std::uint32_t)));
+        }
+
+        auto u64() -> std::uint64_t
+        {
+          return this->uint(sizeof(std::uint64_t));
+        }
+
+        auto string() -> std::string
+        {
+          // read a piece at a time so a corrupt size runs out of file rather than memory
+          std::string str;
+          std::array<char, 4096> buffer;
+          for (std::uint64_t left = this->u64(); left > 0;) {
+            auto size = static_cast<std::size_t>(std::min<std::uint64_t>(left, buffer.size()));
+            this->in.read(buffer.data(), static_cast<std::streamsize>(size));
+            this->check();
+            str.append(buffer.data(), size);
+            left -= size;
+          }
+          return str;
+        }
+
+        void names(BytecodeChunk::GlobalNameSet& names)
+        {
+          for (std::uint64_t count = this->u64(); count > 0; count--) { names.emplace(this->string()); }
+        }
+
+        /**
+         * @brief Reads the magic number and version
+         *
+         * @return True if they are those of files this version writes
+         */
+        auto header() -> bool
+        {
+          std::array<char, MAGIC.size()> magic;
+          this->in.read(magic.data(), magic.size());
+          return this->in && magic == MAGIC && this->u32() == VERSION;
+        }
+
+        /**
+         * @brief Reads the files linked in along with the modification times they had when written
+         */
+        auto dependencies() -> std::vector<std::pair<std::string, std::int64_t>>
+        {
+          std::vector<std::pair<std::string, std::int64_t>> files;
+          for (std::uint64_t count = this->u64(); count > 0; count--) {
+            auto path = this->string();
+            files.emplace_back(std::move(path), static_cast<std::int64_t>(this->u64()));
+          }
+          return files;
+        }
+
+        void check()
+        {
+          if (!this->in) {
+            CompiletimeError::throw_err("bytecode file is cut short");
+          }
+        }
+
+       private:
+        std::istream& in;
+
+        auto uint(std::size_t bytes) -> std::uint64_t
+        {
+          std::uint64_t value = 0;
+          for (std::size_t i = 0; i < bytes; i++) {
+            int c = this->in.get();
+            this->check();
+            value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(c)) << (i * 8);
+          }
+          return value;
+        }
+      };
+
+      void write_constant(Writer& writer, const Value& constant)
+      {
+        switch (constant.type()) {
+          case Value::Type::Nil: {
+            writer.u8(static_cast<std::uint8_t>(ConstantTag::NIL));
+          } break;
+          case Value::Type::Bool: {
+            writer.u8(static_cast<std::uint8_t>(ConstantTag::BOOL));
+            writer.u8(constant.boolean());
+          } break;
+          case Value::Type::Number: {
+            writer.u8(static_cast<std::uint8_t>(ConstantTag::NUMBER));
+            writer.u64(std::bit_cast<std::uint64_t>(constant.number()));
+          } break;
+          case Value::Type::Int: {
+            writer.u8(static_cast<std::uint8_t>(ConstantTag::INT));
+            writer.u64(static_cast<std::uint64_t>(constant.integer()));
+          } break;
+          case Value::Type::String: {
+            auto tag = constant.string_object()->is_interned() ? ConstantTag::INTERNED_STRING : ConstantTag::STRING;
+            writer.u8(static_cast<std::uint8_t>(tag));
+            writer.string(constant.string_view());
+          } break;
+          case Value::Type::Function: {
+            auto fn = constant.function();
+            if (fn->is_compiled()) {
+              writer.u8(static_cast<std::uint8_t>(ConstantTag::FUNCTION));
+              writer.string(fn->name);
+              writer.u64(fn->airity);
+              writer.u64(fn->instruction_ptr);
+            } else {
+              writer.u8(static_cast<std::uint8_t>(ConstantTag::LAZY_FUNCTION));
+              writer.string(fn->name);
+              writer.u64(fn->airity);
+              writer.string(fn->source->text);
+              writer.string(fn->source->file);
+              writer.u64(fn->source->line);
+              writer.u64(fn->source->column);
+            }
+          } break;
+          case Value::Type::Native: {
+            CompiletimeError::throw_err("unable to write native function '", constant.native()->name, "' as bytecode");
+          } break;
+          case Value::Type::Address: {
+            writer.u8(static_cast<std::uint8_t>(ConstantTag::ADDRESS));
+            writer.u64(constant.address().ptr);
+          } break;
+        }
+      }
+
+      auto read_constant(Reader& reader, BytecodeChunk& module) -> Value
+      {
+        switch (static_cast<ConstantTag>(reader.u8())) {
+          case ConstantTag::NIL: {
+            return Value{};
+          }
+          case ConstantTag::BOOL: {
+            return Value{reader.u8() != 0};
+          }
+          case ConstantTag::NUMBER: {
+            return Value{std::bit_cast<Value::NumberType>(reader.u64())};
+          }
+          case ConstantTag::INT: {
+            return Value{static_cast<Value::IntType>(reader.u64())};
+          }
+          case ConstantTag::STRING: {
+            return Value{reader.string()};
+          }
+          case ConstantTag::INTERNED_STRING: {
+            return module.intern(reader.string());
+          }
+          case ConstantTag::FUNCTION: {
+            auto name   = reader.string();
+            auto airity = reader.u64();
+            auto ip     = reader.u64();
+            return Value{make_ref<Function>(std::move(name), airity, ip)};
+          }
+          case ConstantTag::LAZY_FUNCTION: {
+            auto name   = reader.string();
+            auto airity = reader.u64();
+            Function::Source source;
+            source.text   = reader.string();
+            source.file   = reader.string();
+            source.line   = reader.u64();
+            source.column = reader.u64();
+            return Value{make_ref<Function>(std::move(name), airity, std::move(source))};
+          }
+          case ConstantTag::ADDRESS: {
+            return Value{Value::AddressType{reader.u64()}};
+          }
+        }
+        CompiletimeError::throw_err("bytecode file holds a constant of unknown type");
+        return Value{};
+      }
+
+      /**
+       * @brief When the file was last modified, in the clock's own ticks as that is all that is compared
+       */
+      auto modified_at(const std::string& path, std::error_code& error) -> std::int64_t
+      {
+        return static_cast<std::int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+      }
+
+
+      /**
+       * @brief Makes sure every place the program can send the instruction pointer is within its code, a jump past its
+       * end lands on what follows it once linked. Stack slots and counts are not checked, see the namespace
+       */
+      void check_targets(const BytecodeChunk::Program& program)
+      {
+        std::size_t size = program.code.size();
+        for (std::size_t i = 0; i < size; i++) {
+          const auto& instruction = program.code[i];
+          switch (instruction.major_opcode) {
+            case OpCode::JUMP:
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::OR:
+            case OpCode::AND: {
+              if (instruction.modifying_bits > size - i) {
+                CompiletimeError::throw_err("bytecode file jumps past its code");
+              }
+            } break;
+            case OpCode::LOOP: {
+              if (instruction.modifying_bits > i) {
+                CompiletimeError::throw_err("bytecode file loops back before its code");
+              }
+            } break;
+            default:
+              break;
+          }
+        }
+
+        for (const auto& constant : program.constants) {
+          if (constant.is_type(Value::Type::Function)) {
+            auto fn = constant.function();
+            if (fn->is_compiled() && fn->instruction_ptr >= size) {
+              CompiletimeError::throw_err("bytecode file holds a function outside its code");
+            }
+          } else if (constant.is_type(Value::Type::Address) && constant.address().ptr > size) {
+            CompiletimeError::throw_err("bytecode file holds an address outside its code");
+          }
+        }
+      }
+    }  // namespace
+
+    void write(const BytecodeChunk& chunk, std::ostream& out, const std::vector<std::string>& dependencies)
+    {
+      auto program = chunk.save_program();
+      Writer writer(out);
+
+      out.write(MAGIC.data(), MAGIC.size());
+      writer.u32(VERSION);
+
+      writer.u64(dependencies.size());
+      for (const auto& file : dependencies) {
+        std::error_code error;
+        writer.string(file);
+        writer.u64(static_cast<std::uint64_t>(modified_at(file, error)));
+      }
+
+      writer.names(program.defined_globals);
+      writer.names(program.assigned_globals);
+
+      writer.u64(program.constants.size());
+      for (const auto& constant : program.constants) { write_constant(writer, constant); }
+
+      writer.u64(program.code.size());
+      for (const auto& instruction : program.code) {
+        writer.u8(static_cast<std::uint8_t>(instruction.major_opcode));
+        writer.u64(instruction.modifying_bits);
+      }
+
+      writer.u8(program.debug.has_value());
+      if (program.debug) {
+        writer.u64(program.debug->files.size());
+        for (const auto& file : program.debug->files) { writer.string(file); }
+
+        writer.u64(program.debug->lines.size());
+        for (const auto& run : program.debug->lines) {
+          writer.u32(run.first_instruction);
+          writer.u32(run.line);
+          writer.u32(run.column);
+          writer.u32(run.file);
+        }
+
+        // the names are the constants the indices point at
+        writer.u64(program.debug->identifier_cache.size());
+        for (const auto& [name, index] : program.debug->identifier_cache) { writer.u64(index); }
+      }
+    }
+
+    void read(std::istream& in, BytecodeChunk& chunk)
+    {
+      Reader reader(in);
+      if (!reader.header()) {
+        CompiletimeError::throw_err("not a bytecode file of version ", VERSION);
+      }
+      reader.dependencies();
+
+      // strings are interned here first, linking moves them into the chunk
+      BytecodeChunk module;
+      BytecodeChunk::Program program;
+
+      reader.names(program.defined_globals);
+      reader.names(program.assigned_globals);
+
+      for (std::uint64_t count = reader.u64(); count > 0; count--) {
+        program.constants.push_back(read_constant(reader, module));
+      }
+
+      for (std::uint64_t count = reader.u64(); count > 0; count--) {
+        auto opcode = reader.u8();
+        auto bits   = reader.u64();
+        if (opcode > static_cast<std::uint8_t>(OpCode::END)) {
+          CompiletimeError::throw_err("bytecode file holds an unknown instruction");
+        }
+        Instruction instruction{static_cast<OpCode>(opcode), static_cast<std::size_t>(bits)};
+        switch (instruction.major_opcode) {
+          case OpCode::CONSTANT:
+          case OpCode::LOOKUP_GLOBAL:
+          case OpCode::DEFINE_GLOBAL:
+          case OpCode::ASSIGN_GLOBAL: {
+            if (instruction.modifying_bits >= program.constants.size()) {
+              CompiletimeError::throw_err("bytecode file refers to a constant it does not hold");
+            }
+          } break;
+          default:
+            break;
+        }
+        program.code.push_back(instruction);
+      }
+
+      if (reader.u8() != 0) {
+        auto& info = program.debug.emplace();
+        for (std::uint64_t count = reader.u64(); count > 0; count--) { info.files.push_back(reader.string()); }
+
+        for (std::uint64_t count = reader.u64(); count > 0; count--) {
+          BytecodeChunk::DebugInfo::LineRun run;
+          run.first_instruction = reader.u32();
+          run.line              = reader.u32();
+          run.column            = reader.u32();
+          run.file              = reader.u32();
+          if (run.file >= info.files.size()) {
+            CompiletimeError::throw_err("bytecode file refers to a file it does not name");
+          }
+          info.lines.push_back(run);
+        }
+
+        for (std::uint64_t count = reader.u64(); count > 0; count--) {
+          auto index = reader.u64();
+          if (index >= program.constants.size() || !program.constants[index].is_type(Value::Type::String)) {
+            CompiletimeError::throw_err("bytecode file refers to an identifier it does not hold");
+          }
+          info.identifier_cache.try_emplace(program.constants[index].string_view(), index);
+        }
+      }
+
+      check_targets(program);
+
+      module.load_program(program);
+      chunk.link(std::move(module));
+    }
+
+    void compile_file(const std::string& source, const std::string& output)
+    {
+      std::ifstream ifs(source);
+      if (!ifs) {
+        CompiletimeError::throw_err("unable to read ", source);
+      }
+
+      // loadr resolves against the directory of the file, which a bare name does not have
+      // whatever the file is linked after may assign its globals, so none of them can be hoisted out of its loops
+      BytecodeChunk chunk;
+      chunk.assume_globals_assigned();
+      Compiler compiler;
+      CompileStats stats;
+      compiler.compile_module(
+       util::stream_to_string(ifs), chunk, std::filesystem::absolute(source).string(), nullptr, &stats);
+
+      std::ofstream ofs(output, std::ios::binary);
+      write(chunk, ofs, loaded_files(stats));
+      if (!ofs) {
+        CompiletimeError::throw_err("unable to write ", output);
+      }
+    }
+
+    auto is_compiled_path(std::string_view path) noexcept -> bool
+    {
+      return path.ends_with(EXTENSION);
+    }
+
+    auto compiled_path(std::string_view source) -> std::string
+    {
+      return std::filesystem::path(source).replace_extension(EXTENSION).string();
+    }
+
+    auto has_fresh(std::string_view source) -> bool
+    {
+      auto compiled = compiled_path(source);
+
+      std::error_code error;
+      auto compiled_time = std::filesystem::last_write_time(compiled, error);
+      if (error) {
+        return false;
+      }
+      auto source_time = std::filesystem::last_write_time(source, error);
+      if (!error && source_time > compiled_time) {
+        return false;
+      }
+
+      std::ifstream ifs(compiled, std::ios::binary);
+      Reader reader(ifs);
+      try {
+        if (!reader.header()) {
+          return false;
+        }
+        // like the file itself, one whose source is gone is taken as it is
+        for (const auto& [file, time] : reader.dependencies()) {
+          auto current = modified_at(file, error);
+          if (!error && current != time) {
+            return false;
+          }
+        }
+        return true;
+      } catch (CompiletimeError&) {
+        return false;
+      }
+    }
+
+    auto dependencies(std::string_view source) -> std::vector<std::string>
+    {
+      std::ifstream ifs(compiled_path(source), std::ios::binary);
+      Reader reader(ifs);
+      std::vector<std::string> files;
+      try {
+        if (reader.header()) {
+          for (auto& dependency : reader.dependencies()) { files.push_back(std::move(dependency.first)); }
+        }
+      } catch (CompiletimeError&) {
+        files.clear();
+      }
+      return files;
+    }
+  }  // namespace bytecode
+}  // namespace ss
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "code.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ss
+{
+  /**
+   * @brief Compiled scripts stored in .ssc files, so they can be run and loaded without the scanner or parser.
+   *
+   * A file holds the code of one script compiled as a loaded file, with everything it loaded linked in, along with its
+   * constants, line table and the globals it defines and assigns. The files linked in are listed with their modification
+   * times, so changing any of them makes the file stale. Numbers are stored little endian whatever the host.
+   *
+   * Files are trusted like source is. Reading checks the structure of a file, not that its code is safe to run: stack
+   * slots, operand counts and the operand types of typed instructions are taken as written, so a corrupt or hand made file
+   * can still make the VM misbehave
+   */
+  namespace bytecode
+  {
+    /**
+     * @brief Changes whenever the layout of the file or the meaning of an instruction does. Files of other versions are
+     * never read
+     */
+    constexpr std::uint32_t VERSION = 4;
+
+    constexpr std::string_view EXTENSION = ".ssc";
+
+    /**
+     * @brief Writes the code compiled into the chunk since it was last prepared
+     *
+     * @param dependencies The files linked into the code, recorded with their modification times as of now
+     *
+     * @throws CompiletimeError When a constant is a native function, which only exists in the VM that made it
+     */
+    void write(const BytecodeChunk& chunk, std::ostream& out, const std::vector<std::string>& dependencies = {});
+
+    /**
+     * @brief Appends the compiled script to the chunk, as if its source had been compiled as a loaded file
+     *
+     * @throws CompiletimeError When the file is not bytecode, is of another version, is cut short, holds an unknown
+     * instruction, refers to a constant it does not hold or jumps outside its code. Nothing else about the code is checked
+     */
+    void read(std::istream& in, BytecodeChunk& chunk);
+
+    /**
+     * @brief Compiles the source file as a loaded file and writes the result to the output file, along with every file
+     * it loads
+     */
+    void compile_file(const std::string& source, const std::string& output);
+
+    auto is_compiled_path(std::string_view path) noexcept -> bool;
+
+    /**
+     * @brief Where the compiled form of the source file goes, next to it with the extension replaced
+     */
+    auto compiled_path(std::string_view source) -> std::string;
+
+    /**
+     * @brief Check if the compiled form of the source file exists, is of this version, is no older than the source and
+     * none of the files linked into it changed since. A file without its source only needs to be of this version
+     */
+    auto has_fresh(std::string_view source) -> bool;
+
+    /**
+     * @brief The files linked into the compiled form of the source file, empty if it has none or cannot be read
+     */
+    auto dependencies(std::string_view source) -> std::vector<std::string>;
+  }  // namespace bytecode
+}  // namespace ss
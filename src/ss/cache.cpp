@@ -0,0 +1,94 @@
+#include "cache.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace ss
+{
+  CompileCache::CompileCache(std::size_t capacity) noexcept
+   : max_entries(capacity)
+  {}
+
+  auto CompileCache::find(std::string_view src, std::string_view path, const BytecodeChunk& chunk)
+   -> const BytecodeChunk::Program*
+  {
+    auto it = this->index.find(key_of(src, path));
+    if (it == this->index.end() || it->second->src != src || it->second->path != path) {
+      this->statistics.misses++;
+      return nullptr;
+    }
+
+    auto changed = [](const auto& file) { return modified_at(file.first) != file.second; };
+    const auto& files = it->second->files;
+    if (!chunk.is_program_current(it->second->program) || std::any_of(files.begin(), files.end(), changed)) {
+      this->entries.erase(it->second);
+      this->index.erase(it);
+      this->statistics.misses++;
+      return nullptr;
+    }
+
+    this->entries.splice(this->entries.begin(), this->entries, it->second);
+    this->statistics.hits++;
+    return &this->entries.front().program;
+  }
+
+  void CompileCache::insert(
+   std::string src, std::string path, BytecodeChunk::Program program, const std::vector<std::string>& files)
+  {
+    if (this->max_entries == 0) {
+      return;
+    }
+
+    std::uint64_t key = key_of(src, path);
+
+    // a colliding entry is replaced as well, only one program is kept per key
+    if (auto it = this->index.find(key); it != this->index.end()) {
+      this->entries.erase(it->second);
+      this->index.erase(it);
+    } else if (this->entries.size() == this->max_entries) {
+      this->index.erase(this->entries.back().key);
+      this->entries.pop_back();
+      this->statistics.evictions++;
+    }
+
+    FileTimes times;
+    for (const auto& file : files) { times.emplace_back(file, modified_at(file)); }
+
+    this->entries.push_front(Entry{key, std::move(src), std::move(path), std::move(program), std::move(times)});
+    this->index.emplace(key, this->entries.begin());
+  }
+
+  void CompileCache::clear() noexcept
+  {
+    this->entries.clear();
+    this->index.clear();
+  }
+
+  auto CompileCache::size() const noexcept -> std::size_t
+  {
+    return this->entries.size();
+  }
+
+  auto CompileCache::capacity() const noexcept -> std::size_t
+  {
+    return this->max_entries;
+  }
+
+  auto CompileCache::stats() const noexcept -> const Stats&
+  {
+    return this->statistics;
+  }
+
+  auto CompileCache::key_of(std::string_view src, std::string_view path) noexcept -> std::uint64_t
+  {
+    std::uint64_t key = std::hash<std::string_view>{}(src);
+    return key ^ (std::hash<std::string_view>{}(path) + 0x9e3779b97f4a7c15 + (key << 6) + (key >> 2));
+  }
+
+  auto CompileCache::modified_at(const std::string& file) noexcept -> std::filesystem::file_time_type
+  {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(file, error);
+    return error ? std::filesystem::file_time_type::min() : time;
+  }
+}  // namespace ss
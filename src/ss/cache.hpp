@@ -0,0 +1,92 @@
+#pragma once
+
+#include "code.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ss
+{
+  /**
+   * @brief Compiled programs of the scripts a VM ran, so running the same source from the same path again skips the
+   * compiler.
+   *
+   * Entries are keyed on a hash of the source and path, the source and path are kept to tell collisions apart. The files
+   * the script loaded are kept with their modification times, an entry is stale once any of them changes. Once full the
+   * least recently used entry makes room for a new one
+   */
+  class CompileCache
+  {
+   public:
+    struct Stats
+    {
+      std::size_t hits = 0;
+      /**
+       * @brief Lookups that found nothing, or a program gone stale that was dropped
+       */
+      std::size_t misses    = 0;
+      std::size_t evictions = 0;
+    };
+
+    /**
+     * @param capacity Most programs kept at once, 0 keeps none
+     */
+    explicit CompileCache(std::size_t capacity) noexcept;
+
+    /**
+     * @brief Looks up the program compiled from the source and path, marking it as the most recently used
+     *
+     * @return The program, null if there is none still current for the chunk and the files it loaded
+     */
+    auto find(std::string_view src, std::string_view path, const BytecodeChunk& chunk) -> const BytecodeChunk::Program*;
+
+    /**
+     * @brief Adds the program, replacing one compiled from the same source and path
+     *
+     * @param files The files loaded while compiling it, see loaded_files
+     */
+    void insert(
+     std::string src, std::string path, BytecodeChunk::Program program, const std::vector<std::string>& files = {});
+
+    void clear() noexcept;
+
+    auto size() const noexcept -> std::size_t;
+    auto capacity() const noexcept -> std::size_t;
+    auto stats() const noexcept -> const Stats&;
+
+   private:
+    using FileTimes = std::vector<std::pair<std::string, std::filesystem::file_time_type>>;
+
+    struct Entry
+    {
+      std::uint64_t key;
+      std::string src;
+      std::string path;
+      BytecodeChunk::Program program;
+      FileTimes files;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    std::size_t max_entries;
+    /**
+     * @brief Most recently used first
+     */
+    EntryList entries;
+    std::unordered_map<std::uint64_t, EntryList::iterator> index;
+    Stats statistics;
+
+    static auto key_of(std::string_view src, std::string_view path) noexcept -> std::uint64_t;
+    /**
+     * @brief When the file was last modified, the earliest time there is for one that cannot be found
+     */
+    static auto modified_at(const std::string& file) noexcept -> std::filesystem::file_time_type;
+  };
+}  // namespace ss
@@ -14,6 +14,83 @@ namespace ss
     this->ostream_initial_state->copyfmt(*this->ostream);
   }
 
+  auto VMConfig::set_backend(Backend backend) noexcept -> VMConfig&
+  {
+    this->vm_backend = backend;
+    return *this;
+  }
+
+  auto VMConfig::set_gc_pause_budget(std::chrono::microseconds budget) noexcept -> VMConfig&
+  {
+    this->gc_budget = budget;
+    return *this;
+  }
+
+  auto VMConfig::set_memory_limit(std::size_t limit) noexcept -> VMConfig&
+  {
+    this->max_memory = limit;
+    return *this;
+  }
+
+  auto VMConfig::set_lazy_functions(bool lazy_functions) noexcept -> VMConfig&
+  {
+    this->lazy = lazy_functions;
+    return *this;
+  }
+
+  auto VMConfig::set_module_threads(std::size_t threads) noexcept -> VMConfig&
+  {
+    this->modules = threads;
+    return *this;
+  }
+
+  auto VMConfig::set_compile_stats(bool compile_stats) noexcept -> VMConfig&
+  {
+    this->stats = compile_stats;
+    return *this;
+  }
+
+  auto VMConfig::set_compile_cache_size(std::size_t size) noexcept -> VMConfig&
+  {
+    this->cache_size = size;
+    return *this;
+  }
+
+  auto VMConfig::backend() const noexcept -> Backend
+  {
+    return this->vm_backend;
+  }
+
+  auto VMConfig::gc_pause_budget() const noexcept -> std::chrono::microseconds
+  {
+    return this->gc_budget;
+  }
+
+  auto VMConfig::memory_limit() const noexcept -> std::size_t
+  {
+    return this->max_memory;
+  }
+
+  auto VMConfig::lazy_functions() const noexcept -> bool
+  {
+    return this->lazy;
+  }
+
+  auto VMConfig::module_threads() const noexcept -> std::size_t
+  {
+    return this->modules;
+  }
+
+  auto VMConfig::compile_stats() const noexcept -> bool
+  {
+    return this->stats;
+  }
+
+  auto VMConfig::compile_cache_size() const noexcept -> std::size_t
+  {
+    return this->cache_size;
+  }
+
   void VMConfig::reset_istream()
   {
     this->istream->copyfmt(*this->istream_initial_state);
@@ -1,15 +1,17 @@
 #pragma once
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 
 namespace ss
 {
-  constexpr bool DISASSEMBLE_CHUNK        = true;
+  constexpr bool DISASSEMBLE_CHUNK        = false;
   constexpr bool DISASSEMBLE_INSTRUCTIONS = false;
   constexpr bool PRINT_STACK              = false;
   constexpr bool PRINT_CONSTANTS          = false;
   constexpr bool ECHO_INPUT               = false;
+  constexpr bool PRINT_GENERIC_OPS        = false;
 
   template <typename T>
   concept Writable = requires(T& t)
@@ -32,11 +34,66 @@ namespace ss
   class VMConfig
   {
    public:
+    /**
+     * @brief Instruction set the VM executes
+     */
+    enum class Backend
+    {
+      /**
+       * @brief Every operand goes through the value stack
+       */
+      STACK,
+      /**
+       * @brief Arithmetic and moves address call frame slots and constants directly
+       */
+      REGISTER,
+    };
+
+    /**
+     * @brief Longest the garbage collector may pause the script for at a time, unless told to collect everything
+     */
+    static constexpr std::chrono::microseconds DEFAULT_GC_PAUSE_BUDGET{500};
+
     static VMConfig basic;
 
     VMConfig(std::istream* istream = &std::cin, std::ostream* ostream = &std::cout);
     ~VMConfig() = default;
 
+    /**
+     * @brief Each setter returns the config, so the options that differ from the defaults can be chained onto the
+     * constructor
+     */
+    auto set_backend(Backend backend) noexcept -> VMConfig&;
+    auto set_gc_pause_budget(std::chrono::microseconds budget) noexcept -> VMConfig&;
+    auto set_memory_limit(std::size_t limit) noexcept -> VMConfig&;
+    auto set_lazy_functions(bool lazy_functions) noexcept -> VMConfig&;
+    auto set_module_threads(std::size_t threads) noexcept -> VMConfig&;
+    auto set_compile_stats(bool compile_stats) noexcept -> VMConfig&;
+    auto set_compile_cache_size(std::size_t size) noexcept -> VMConfig&;
+
+    auto backend() const noexcept -> Backend;
+    auto gc_pause_budget() const noexcept -> std::chrono::microseconds;
+    /**
+     * @brief Most bytes the VM may hold across its stack, constants, strings, functions and globals. 0 for no limit
+     */
+    auto memory_limit() const noexcept -> std::size_t;
+    /**
+     * @brief Whether function bodies are compiled on their first call rather than with the rest of the script
+     */
+    auto lazy_functions() const noexcept -> bool;
+    /**
+     * @brief Threads the files a script loads are compiled on ahead of the script. 0 compiles each one as it is loaded
+     */
+    auto module_threads() const noexcept -> std::size_t;
+    /**
+     * @brief Whether compiling records the time spent in each phase and what was produced
+     */
+    auto compile_stats() const noexcept -> bool;
+    /**
+     * @brief Most compiled scripts run_script keeps around to run again without compiling them. 0 keeps none
+     */
+    auto compile_cache_size() const noexcept -> std::size_t;
+
     template <Writable... Args>
     void write(Args&&... args)
     {
@@ -73,6 +130,13 @@ namespace ss
    private:
     std::istream* istream;
     std::ostream* ostream;
+    Backend vm_backend                  = Backend::STACK;
+    std::chrono::microseconds gc_budget = DEFAULT_GC_PAUSE_BUDGET;
+    std::size_t max_memory              = 0;
+    bool lazy                           = false;
+    std::size_t modules                 = 0;
+    bool stats                          = false;
+    std::size_t cache_size              = 0;
 
     std::shared_ptr<std::ios> istream_initial_state;
     std::shared_ptr<std::ios> ostream_initial_state;
@@ -1,8 +1,13 @@
 #include "code.hpp"
 
+#include "bytecode.hpp"
 #include "datatypes.hpp"
+#include "simd.hpp"
 #include "util.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
@@ -11,6 +16,23 @@
 
 namespace ss
 {
+  namespace
+  {
+    /**
+     * @brief Lazily compiled functions are compiled in place on their first call, every run of a program gets its own
+     */
+    auto copy_for_program(const Value& constant) -> Value
+    {
+      if (constant.type() == Value::Type::Function) {
+        auto fn = constant.function();
+        if (!fn->is_compiled()) {
+          return Value{make_ref<Function>(fn->name, fn->airity, *fn->source)};
+        }
+      }
+      return constant;
+    }
+  }  // namespace
+
   auto operator<<(std::ostream& ostream, const OpCode& code) -> std::ostream&
   {
     return ostream << to_string(code);
@@ -32,34 +54,66 @@ namespace ss
                    << ", column: " << token.column << " }";
   }
 
+  BytecodeChunk::BytecodeChunk(MemoryTracker* memory) noexcept
+   : constants(memory)
+   , stack(memory)
+   , globals(memory)
+   , interned_strings(memory)
+   , all_globals_assigned(false)
+   , debug(nullptr)
+  {}
+
   void BytecodeChunk::prepare() noexcept
   {
     this->code.clear();
     this->constants.clear();
     this->stack.clear();
-    this->lines.clear();
-    this->last_line            = 0;
-    this->instructions_on_line = 0;
-    this->identifier_cache.clear();
+    this->defined_globals.clear();
+    this->debug.reset();
+
+    // nothing can reach a string only the table refers to anymore, keeping it would grow the table with every script
+    std::erase_if(this->interned_strings, [](const auto& entry) { return entry.second.use_count() == 1; });
   }
 
-  void BytecodeChunk::write(Instruction i, std::size_t line) noexcept
+  void BytecodeChunk::visit_roots(const std::function<void(const Value&)>& f) const
   {
+    for (const auto& constant : this->constants) { f(constant); }
+    for (const auto& global : this->globals) { f(global.second); }
+  }
+
+  void BytecodeChunk::visit_stack(const std::function<void(const Value&)>& f) const
+  {
+    for (const auto& value : this->stack) { f(value); }
+  }
+
+  void BytecodeChunk::write(Instruction i, std::size_t line, std::size_t column, std::size_t file)
+  {
+    this->add_line(line, column, file);
     this->code.push_back(std::move(i));
-    this->add_line(line);
   }
 
-  void BytecodeChunk::write_constant(Value v, std::size_t line) noexcept
+  void BytecodeChunk::write_constant(Value v, std::size_t line, std::size_t column, std::size_t file)
   {
     this->constants.push_back(std::move(v));
     Instruction i{
      OpCode::CONSTANT,
      this->constants.size() - 1,
     };
-    this->write(i, line);
+    this->write(i, line, column, file);
+  }
+
+  auto BytecodeChunk::add_file(std::string_view name) -> std::size_t
+  {
+    auto& files = this->debug_info().files;
+    auto it     = std::find(files.begin(), files.end(), name);
+    if (it != files.end()) {
+      return it - files.begin();
+    }
+    files.emplace_back(name);
+    return files.size() - 1;
   }
 
-  auto BytecodeChunk::insert_constant(Value v) noexcept -> std::size_t
+  auto BytecodeChunk::insert_constant(Value v) -> std::size_t
   {
     this->constants.push_back(std::move(v));
     return this->constants.size() - 1;
@@ -70,7 +124,17 @@ namespace ss
     return this->constants[offset];
   }
 
-  void BytecodeChunk::push_stack(Value v) noexcept
+  auto BytecodeChunk::constant_ref(std::size_t offset) const noexcept -> const Value&
+  {
+    return this->constants[offset];
+  }
+
+  auto BytecodeChunk::constant_count() const noexcept -> std::size_t
+  {
+    return this->constants.size();
+  }
+
+  void BytecodeChunk::push_stack(Value v)
   {
     this->stack.push_back(std::move(v));
   }
@@ -92,31 +156,50 @@ namespace ss
     return this->stack.empty();
   }
 
-  void BytecodeChunk::add_line(std::size_t line) noexcept
+  void BytecodeChunk::add_line(std::size_t line, std::size_t column, std::size_t file)
   {
-    if (this->last_line == line) {
-      // same line number
-      this->instructions_on_line += 1;
-    } else {
-      this->lines.push_back(this->instructions_on_line);
-      this->last_line            = line;
-      this->instructions_on_line = 1;  // current instruction
+    auto& lines = this->debug_info().lines;
+    if (!lines.empty() && lines.back().line == line && lines.back().file == file) {
+      return;
+    }
+
+    lines.push_back(DebugInfo::LineRun{
+     static_cast<std::uint32_t>(this->code.size()),
+     static_cast<std::uint32_t>(line),
+     static_cast<std::uint32_t>(column),
+     static_cast<std::uint32_t>(file),
+    });
+  }
+
+  auto BytecodeChunk::run_at(std::size_t offset) const noexcept -> const DebugInfo::LineRun*
+  {
+    if (this->debug == nullptr) {
+      return nullptr;
     }
+
+    // the last run starting at or before the offset
+    const auto& lines = this->debug->lines;
+    auto run = std::upper_bound(lines.begin(), lines.end(), offset, [](std::size_t off, const DebugInfo::LineRun& r) {
+      return off < r.first_instruction;
+    });
+    return run == lines.begin() ? nullptr : &*(run - 1);
   }
 
   auto BytecodeChunk::line_at(std::size_t offset) const noexcept -> std::size_t
   {
-    std::size_t accum = 0;
-    std::size_t line  = 0;
-    for (const auto num_instructions_on_line : this->lines) {
-      if (accum + num_instructions_on_line > offset) {
-        return line;
-      } else {
-        accum += num_instructions_on_line;
-      }
-      line++;
+    const DebugInfo::LineRun* run = this->run_at(offset);
+    return run == nullptr ? 0 : run->line;
+  }
+
+  auto BytecodeChunk::location_at(std::size_t offset) const noexcept -> SourceLocation
+  {
+    const DebugInfo::LineRun* run = this->run_at(offset);
+    if (run == nullptr) {
+      return SourceLocation{"", 0, 0};
     }
-    return line;
+    const auto& files     = this->debug->files;
+    std::string_view file = run->file < files.size() ? std::string_view(files[run->file]) : "";
+    return SourceLocation{file, run->line, run->column};
   }
 
   auto BytecodeChunk::peek_stack(std::size_t index) const noexcept -> Value
@@ -159,29 +242,45 @@ namespace ss
     return this->code.end();
   }
 
-  auto BytecodeChunk::find_ident(std::string_view name) const noexcept -> IdentifierCacheEntry
+  auto BytecodeChunk::find_ident(std::string_view name) const noexcept -> std::optional<std::size_t>
   {
-    return this->identifier_cache.find(name);
+    if (this->debug == nullptr) {
+      return std::nullopt;
+    }
+    auto entry = this->debug->identifier_cache.find(name);
+    if (entry == this->debug->identifier_cache.end()) {
+      return std::nullopt;
+    }
+    return entry->second;
   }
 
-  auto BytecodeChunk::is_entry_found(IdentifierCacheEntry entry) const noexcept -> bool
+  auto BytecodeChunk::add_ident(std::string_view name) -> std::size_t
   {
-    return entry != this->identifier_cache.end();
+    Value ident = this->intern(name);
+    auto indx   = this->insert_constant(ident);
+    // key on the interned characters, the token the name came from may not outlive the chunk
+    this->debug_info().identifier_cache[ident.string_view()] = indx;
+    return indx;
   }
 
-  auto BytecodeChunk::add_ident(std::string_view name) noexcept -> std::size_t
+  auto BytecodeChunk::intern(std::string_view str) -> Value
   {
-    auto indx                    = this->insert_constant(Value(std::string(name)));
-    this->identifier_cache[name] = indx;
-    return indx;
+    auto entry = this->interned_strings.find(str);
+    if (entry != this->interned_strings.end()) {
+      return Value(entry->second);
+    }
+
+    auto obj = std::make_shared<String>(std::string(str), &this->interned_strings);
+    this->interned_strings.emplace(obj->view(), obj);
+    return Value(obj);
   }
 
-  void BytecodeChunk::set_global(Value::StringType&& name, Value value) noexcept
+  void BytecodeChunk::set_global(Value::StringType&& name, Value value)
   {
     this->globals[name] = value;
   }
 
-  auto BytecodeChunk::find_global(Value::StringType name) noexcept -> GlobalMap::iterator
+  auto BytecodeChunk::find_global(std::string_view name) noexcept -> GlobalMap::iterator
   {
     return this->globals.find(name);
   }
@@ -191,6 +290,164 @@ namespace ss
     return it != this->globals.end();
   }
 
+  void BytecodeChunk::mark_global_assigned(std::string_view name) noexcept
+  {
+    this->assigned_globals.emplace(name);
+  }
+
+  auto BytecodeChunk::is_global_assigned(std::string_view name) const noexcept -> bool
+  {
+    return this->all_globals_assigned || this->assigned_globals.find(name) != this->assigned_globals.end();
+  }
+
+  void BytecodeChunk::assume_globals_assigned() noexcept
+  {
+    this->all_globals_assigned = true;
+  }
+
+  void BytecodeChunk::mark_global_defined(std::string_view name) noexcept
+  {
+    this->defined_globals.emplace(name);
+  }
+
+  auto BytecodeChunk::is_global_defined(std::string_view name) const noexcept -> bool
+  {
+    return this->globals.find(name) != this->globals.end() || this->defined_globals.find(name) != this->defined_globals.end();
+  }
+
+  void BytecodeChunk::shrink_to_fit()
+  {
+    this->code.shrink_to_fit();
+    this->constants.shrink_to_fit();
+    if (this->debug != nullptr) {
+      this->debug->lines.shrink_to_fit();
+    }
+  }
+
+  auto BytecodeChunk::has_debug_info() const noexcept -> bool
+  {
+    return this->debug != nullptr;
+  }
+
+  auto BytecodeChunk::detach_debug_info() noexcept -> std::unique_ptr<DebugInfo>
+  {
+    return std::move(this->debug);
+  }
+
+  void BytecodeChunk::attach_debug_info(std::unique_ptr<DebugInfo> info) noexcept
+  {
+    this->debug = std::move(info);
+  }
+
+  void BytecodeChunk::link(BytecodeChunk&& module)
+  {
+    std::size_t code_offset     = this->code.size();
+    std::size_t constant_offset = this->constants.size();
+
+    this->constants.reserve(constant_offset + module.constants.size());
+    for (auto& constant : module.constants) {
+      switch (constant.type()) {
+        case Value::Type::String: {
+          // equality of interned strings is decided by their pool, they have to move to this one
+          if (constant.string_object()->is_interned()) {
+            constant = this->intern(constant.string_view());
+          }
+        } break;
+        case Value::Type::Function: {
+          auto fn = constant.function();
+          if (fn->is_compiled()) {
+            fn->instruction_ptr += code_offset;
+          }
+        } break;
+        case Value::Type::Address: {
+          constant = Value{Value::AddressType{constant.address().ptr + code_offset}};
+        } break;
+        default:
+          break;
+      }
+      this->constants.push_back(std::move(constant));
+    }
+
+    this->code.reserve(code_offset + module.code.size());
+    for (Instruction i : module.code) {
+      switch (i.major_opcode) {
+        case OpCode::CONSTANT:
+        case OpCode::LOOKUP_GLOBAL:
+        case OpCode::DEFINE_GLOBAL:
+        case OpCode::ASSIGN_GLOBAL: {
+          i.modifying_bits += constant_offset;
+        } break;
+        default:
+          break;
+      }
+      this->code.push_back(i);
+    }
+
+    if (module.debug != nullptr) {
+      auto& info = this->debug_info();
+      for (const auto& run : module.debug->lines) {
+        info.lines.push_back(DebugInfo::LineRun{
+         static_cast<std::uint32_t>(run.first_instruction + code_offset),
+         run.line,
+         run.column,
+         static_cast<std::uint32_t>(this->add_file(module.debug->files[run.file])),
+        });
+      }
+      for (const auto& [name, index] : module.debug->identifier_cache) {
+        const Value& ident = this->constants[index + constant_offset];
+        info.identifier_cache.try_emplace(ident.string_view(), index + constant_offset);
+      }
+    }
+
+    this->assigned_globals.merge(module.assigned_globals);
+    this->defined_globals.merge(module.defined_globals);
+
+    module.code.clear();
+    module.constants.clear();
+    module.interned_strings.clear();
+    module.debug.reset();
+  }
+
+  auto BytecodeChunk::save_program() const -> Program
+  {
+    Program program;
+    program.code = this->code;
+    program.constants.reserve(this->constants.size());
+    for (const auto& constant : this->constants) { program.constants.push_back(copy_for_program(constant)); }
+    if (this->debug != nullptr) {
+      program.debug = *this->debug;
+    }
+    program.defined_globals  = this->defined_globals;
+    program.assigned_globals = this->assigned_globals;
+    return program;
+  }
+
+  void BytecodeChunk::load_program(const Program& program)
+  {
+    this->code = program.code;
+    this->constants.reserve(program.constants.size());
+    for (const auto& constant : program.constants) { this->constants.push_back(copy_for_program(constant)); }
+    if (program.debug) {
+      this->debug = std::make_unique<DebugInfo>(*program.debug);
+    }
+    this->defined_globals = program.defined_globals;
+    this->assigned_globals.insert(program.assigned_globals.begin(), program.assigned_globals.end());
+  }
+
+  auto BytecodeChunk::is_program_current(const Program& program) const noexcept -> bool
+  {
+    // assignments are only ever added, and the program's were all in the chunk when it was saved
+    return this->assigned_globals.size() == program.assigned_globals.size();
+  }
+
+  auto BytecodeChunk::debug_info() -> DebugInfo&
+  {
+    if (this->debug == nullptr) {
+      this->debug = std::make_unique<DebugInfo>();
+    }
+    return *this->debug;
+  }
+
   void BytecodeChunk::print_stack(VMConfig& cfg) const noexcept
   {
     cfg.write("        | ");
@@ -208,112 +465,205 @@ namespace ss
     for (std::size_t i = 0; i < this->constants.size(); i++) { cfg.write_line(i, "=", this->constant_at(i)); }
   }
 
-  Scanner::Scanner(std::string&& src) noexcept
+  Scanner::Scanner(std::string&& src, std::pmr::memory_resource* m, std::size_t l, std::size_t c) noexcept
    : source(std::move(src))
+   , memory(m)
    , current_char(this->source.begin())
-   , line(1)
-   , column(1)
+   , line(l)
+   , column(c)
   {}
 
-  auto Scanner::scan() -> std::vector<Token>
+  auto Scanner::scan() -> TokenList
   {
-    std::vector<Token> tokens;
+    TokenList tokens(this->memory);
+    // a token every few characters is typical, reserving up front avoids abandoning grown copies in the arena
+    tokens.reserve(this->source.size() / 4 + 1);
 
-    for (this->skip_whitespace(); !this->is_at_end(); this->skip_whitespace()) {
-      char c = *this->starting_char;
+    Token token = this->next();
+    for (; token.type != Token::Type::END_OF_FILE; token = this->next()) { tokens.push_back(std::move(token)); }
+    tokens.push_back(std::move(token));
 
-      Token::Type t;
+    return tokens;
+  }
 
-      switch (c) {
-        case '(': {
-          t = Token::Type::LEFT_PAREN;
-        } break;
-        case ')': {
-          t = Token::Type::RIGHT_PAREN;
-        } break;
-        case '{': {
-          t = Token::Type::LEFT_BRACE;
-        } break;
-        case '}': {
-          t = Token::Type::RIGHT_BRACE;
-        } break;
-        case ',': {
-          t = Token::Type::COMMA;
-        } break;
-        case '.': {
-          t = Token::Type::DOT;
-        } break;
-        case ';': {
-          t = Token::Type::SEMICOLON;
-        } break;
-        case '+': {
-          t = Token::Type::PLUS;
-        } break;
-        case '-': {
-          t = Token::Type::MINUS;
-        } break;
-        case '*': {
-          t = Token::Type::STAR;
-        } break;
-        case '/': {
-          t = Token::Type::SLASH;
-        } break;
-        case '%': {
-          t = Token::Type::MODULUS;
-        } break;
-        case '!': {
-          t = this->advance_if_match('=') ? Token::Type::BANG_EQUAL : Token::Type::BANG;
-        } break;
-        case '=': {
-          t = this->advance_if_match('=') ? Token::Type::EQUAL_EQUAL
-            : this->advance_if_match('>') ? Token::Type::ARROW
-                                          : Token::Type::EQUAL;
-        } break;
-        case '<': {
-          t = this->advance_if_match('=') ? Token::Type::LESS_EQUAL : Token::Type::LESS;
-        } break;
-        case '>': {
-          t = this->advance_if_match('=') ? Token::Type::GREATER_EQUAL : Token::Type::GREATER;
-        } break;
-        case '"': {
-          t = Token::Type::STRING;
-        } break;
-        default: {
-          if (this->is_digit(c)) {
-            t = Token::Type::NUMBER;
-          } else if (this->is_alpha(c)) {
-            t = Token::Type::IDENTIFIER;
-          } else {
-            this->error("invalid character '", *this->starting_char, '\'');
-          }
+  auto Scanner::next() -> Token
+  {
+    this->skip_whitespace();
+    if (this->is_at_end()) {
+      return this->make_token(Token::Type::END_OF_FILE);
+    }
+
+    char c = *this->starting_char;
+
+    Token::Type t;
+
+    switch (c) {
+      case '(': {
+        t = Token::Type::LEFT_PAREN;
+      } break;
+      case ')': {
+        t = Token::Type::RIGHT_PAREN;
+      } break;
+      case '{': {
+        t = Token::Type::LEFT_BRACE;
+      } break;
+      case '}': {
+        t = Token::Type::RIGHT_BRACE;
+      } break;
+      case ',': {
+        t = Token::Type::COMMA;
+      } break;
+      case '.': {
+        t = Token::Type::DOT;
+      } break;
+      case ';': {
+        t = Token::Type::SEMICOLON;
+      } break;
+      case '+': {
+        t = Token::Type::PLUS;
+      } break;
+      case '-': {
+        t = Token::Type::MINUS;
+      } break;
+      case '*': {
+        t = Token::Type::STAR;
+      } break;
+      case '/': {
+        t = Token::Type::SLASH;
+      } break;
+      case '%': {
+        t = Token::Type::MODULUS;
+      } break;
+      case '&': {
+        t = Token::Type::AMPERSAND;
+      } break;
+      case '|': {
+        t = Token::Type::PIPE;
+      } break;
+      case '^': {
+        t = Token::Type::CARET;
+      } break;
+      case '~': {
+        t = Token::Type::TILDE;
+      } break;
+      case '!': {
+        t = this->advance_if_match('=') ? Token::Type::BANG_EQUAL : Token::Type::BANG;
+      } break;
+      case '=': {
+        t = this->advance_if_match('=') ? Token::Type::EQUAL_EQUAL
+          : this->advance_if_match('>') ? Token::Type::ARROW
+                                        : Token::Type::EQUAL;
+      } break;
+      case '<': {
+        t = this->advance_if_match('=') ? Token::Type::LESS_EQUAL
+          : this->advance_if_match('<') ? Token::Type::SHIFT_LEFT
+                                        : Token::Type::LESS;
+      } break;
+      case '>': {
+        t = this->advance_if_match('=') ? Token::Type::GREATER_EQUAL
+          : this->advance_if_match('>') ? Token::Type::SHIFT_RIGHT
+                                        : Token::Type::GREATER;
+      } break;
+      case '"': {
+        t = Token::Type::STRING;
+      } break;
+      default: {
+        if (this->is_digit(c)) {
+          t = Token::Type::NUMBER;
+        } else if (this->is_alpha(c)) {
+          t = Token::Type::IDENTIFIER;
+        } else {
+          this->error("invalid character '", *this->starting_char, '\'');
         }
       }
+    }
 
-      this->advance();
+    this->advance();
 
-      Token token;
+    Token token;
 
-      switch (t) {
-        case Token::Type::STRING: {
-          token = this->make_string();
-        } break;
-        case Token::Type::NUMBER: {
-          token = this->make_number();
-        } break;
-        case Token::Type::IDENTIFIER: {
-          token = this->make_identifier();
-        } break;
-        default: {
-          token = this->make_token(t);
-        } break;
-      }
+    switch (t) {
+      case Token::Type::STRING: {
+        token = this->make_string();
+      } break;
+      case Token::Type::NUMBER: {
+        token = this->make_number();
+      } break;
+      case Token::Type::IDENTIFIER: {
+        token = this->make_identifier();
+      } break;
+      default: {
+        token = this->make_token(t);
+      } break;
+    }
+
+    return token;
+  }
+
+  auto Scanner::resource() const noexcept -> std::pmr::memory_resource*
+  {
+    return this->memory;
+  }
 
-      tokens.push_back(std::move(token));
+  TokenStream::TokenStream(Scanner& s)
+   : scanner(&s)
+   , buffer(INITIAL_CAPACITY, s.resource())
+   , position(0)
+   , end(0)
+  {}
+
+  TokenStream::TokenStream(TokenList&& tokens) noexcept
+   : scanner(nullptr)
+   , buffer(std::move(tokens))
+   , position(0)
+   , end(this->buffer.size())
+  {}
+
+  auto TokenStream::peek(std::size_t n) -> const Token&
+  {
+    std::size_t index = this->position + n;
+
+    if (this->scanner == nullptr) {
+      return this->buffer[std::min(index, this->end - 1)];
+    }
+
+    while (this->end <= index) {
+      // the previous token stays buffered along with everything ahead of it
+      std::size_t first = this->position == 0 ? 0 : this->position - 1;
+      if (this->end - first == this->buffer.size()) {
+        this->grow(first);
+      }
+      this->buffer[this->end & (this->buffer.size() - 1)] = this->scanner->next();
+      this->end++;
     }
 
-    tokens.push_back(std::move(this->make_token(Token::Type::END_OF_FILE)));
+    return this->buffer[index & (this->buffer.size() - 1)];
+  }
 
-    return tokens;
+  auto TokenStream::previous() const noexcept -> const Token&
+  {
+    std::size_t index = this->position - 1;
+    return this->buffer[this->scanner == nullptr ? index : index & (this->buffer.size() - 1)];
+  }
+
+  void TokenStream::advance()
+  {
+    this->peek();
+    this->position++;
+  }
+
+  auto TokenStream::resource() const noexcept -> std::pmr::memory_resource*
+  {
+    return this->buffer.get_allocator().resource();
+  }
+
+  void TokenStream::grow(std::size_t first)
+  {
+    TokenList larger(this->buffer.size() * 2, this->buffer.get_allocator());
+    for (std::size_t i = first; i < this->end; i++) {
+      larger[i & (larger.size() - 1)] = std::move(this->buffer[i & (this->buffer.size() - 1)]);
+    }
+    this->buffer = std::move(larger);
   }
 
   auto Scanner::make_token(Token::Type t) const noexcept -> Token
@@ -329,12 +679,13 @@ namespace ss
 
   auto Scanner::make_string() -> Token
   {
-    while (!this->is_at_end() && this->peek() != '"') {
-      if (this->peek() == '\n') {
-        this->line++;
-      }
-      this->advance();
-    }
+    const char* from = this->current_char.base();
+    const char* to   = simd::skip(simd::CharClass::STRING_BODY, from, this->source_end());
+
+    // the column keeps counting across newlines within a string, tokens after it are placed relative to its start
+    this->line += simd::count_newlines(from, to);
+    this->column += to - from;
+    this->current_char += to - from;
 
     if (this->is_at_end()) {
       this->error("unterminated string");
@@ -353,137 +704,213 @@ namespace ss
 
   auto Scanner::make_number() -> Token
   {
-    while (this->is_digit(this->peek())) { this->advance(); }
+    // underscores may separate digits, but never start or end a run of them
+    auto digits = [this](auto is_valid) {
+      while (is_valid(this->peek()) || (this->peek() == '_' && is_valid(this->peek_next()))) { this->advance(); }
+    };
+    auto decimal = [this](char c) { return this->is_digit(c); };
+
+    int base        = 10;
+    bool fractional = false;
 
-    if (!this->is_at_end() && this->peek() == '.' && this->is_digit(this->peek_next())) {
-      // advance past the "."
+    if (*this->starting_char == '0' && (this->peek() == 'x' || this->peek() == 'X') && this->is_hex_digit(this->peek_next())) {
+      base = 16;
       this->advance();
+      digits([this](char c) { return this->is_hex_digit(c); });
+    } else if (
+     *this->starting_char == '0' && (this->peek() == 'b' || this->peek() == 'B') && this->is_binary_digit(this->peek_next())) {
+      base = 2;
+      this->advance();
+      digits([this](char c) { return this->is_binary_digit(c); });
+    } else {
+      digits(decimal);
+
+      if (!this->is_at_end() && this->peek() == '.' && this->is_digit(this->peek_next())) {
+        // advance past the "."
+        this->advance();
 
-      while (this->is_digit(this->peek())) { this->advance(); }
+        digits(decimal);
+        fractional = true;
+      }
     }
 
-    return this->make_token(Token::Type::NUMBER);
-  }
+    Token token = this->make_token(Token::Type::NUMBER);
 
-  auto Scanner::make_identifier() -> Token
-  {
-    while (this->is_alpha(this->peek()) || this->is_digit(this->peek())) { this->advance(); }
+    std::string_view text = token.lexeme;
+    if (base != 10) {
+      // skip the prefix
+      text.remove_prefix(2);
+    }
 
-    return this->make_token(this->identifier());
-  }
+    std::string stripped;
+    if (text.find('_') != std::string_view::npos) {
+      stripped.reserve(text.size());
+      for (char c : text) {
+        if (c != '_') {
+          stripped.push_back(c);
+        }
+      }
+      text = stripped;
+    }
 
-  auto Scanner::identifier() -> Token::Type
-  {
-    switch (*this->starting_char) {
-      case 'a': {
-        return this->check_keyword(1, 2, "nd", Token::Type::AND);
+    const char* begin = text.data();
+    const char* end   = text.data() + text.size();
+
+    if (base != 10) {
+      // hex and binary literals are bit patterns, so the full 64 bits are usable
+      std::uint64_t bits;
+      auto result = std::from_chars(begin, end, bits, base);
+      if (result.ec != std::errc() || result.ptr != end) {
+        this->error("integer literal '", token.lexeme, "' does not fit in 64 bits");
       }
-      case 'b': {
-        return this->check_keyword(1, 4, "reak", Token::Type::BREAK);
+      token.value = Value(static_cast<Value::IntType>(bits));
+      return token;
+    }
+
+    if (!fractional) {
+      Value::IntType i;
+      auto result = std::from_chars(begin, end, i);
+      // integer literals too large for an int fall through and become numbers
+      if (result.ec == std::errc() && result.ptr == end) {
+        token.value = Value(i);
+        return token;
       }
-      case 'c': {
-        switch (*(this->starting_char + 1)) {
-          case 'l': {
-            return this->check_keyword(2, 3, "ass", Token::Type::CLASS);
-          }
-          case 'o': {
-            return this->check_keyword(2, 2, "nt", Token::Type::CONTINUE);
-          }
-          default:
-            return Token::Type::IDENTIFIER;
-        }
+    }
+
+    Value::NumberType n;
+    auto result = std::from_chars(begin, end, n);
+    if (result.ec != std::errc() || result.ptr != end) {
+      this->error("unparsable number '", token.lexeme, '\'');
+    }
+    token.value = Value(n);
+
+    return token;
+  }
+
+  namespace keywords
+  {
+    namespace
+    {
+      struct Keyword
+      {
+        std::string_view name;
+        Token::Type type;
+      };
+
+      constexpr std::array LIST = {
+       Keyword{"and", Token::Type::AND},
+       Keyword{"break", Token::Type::BREAK},
+       Keyword{"class", Token::Type::CLASS},
+       Keyword{"cont", Token::Type::CONTINUE},
+       Keyword{"else", Token::Type::ELSE},
+       Keyword{"end", Token::Type::END},
+       Keyword{"false", Token::Type::FALSE},
+       Keyword{"for", Token::Type::FOR},
+       Keyword{"fn", Token::Type::FN},
+       Keyword{"if", Token::Type::IF},
+       Keyword{"let", Token::Type::LET},
+       Keyword{"load", Token::Type::LOAD},
+       Keyword{"loadr", Token::Type::LOADR},
+       Keyword{"loop", Token::Type::LOOP},
+       Keyword{"match", Token::Type::MATCH},
+       Keyword{"nil", Token::Type::NIL},
+       Keyword{"or", Token::Type::OR},
+       Keyword{"print", Token::Type::PRINT},
+       Keyword{"ret", Token::Type::RETURN},
+       Keyword{"true", Token::Type::TRUE},
+       Keyword{"while", Token::Type::WHILE},
+      };
+
+      /**
+       * @brief Must be a power of two
+       */
+      constexpr std::size_t TABLE_SIZE = 64;
+
+      struct Table
+      {
+        std::size_t first_mult;
+        std::size_t last_mult;
+        std::size_t min_length;
+        std::size_t max_length;
+        std::array<Keyword, TABLE_SIZE> slots;
+      };
+
+      constexpr auto hash(std::string_view word, std::size_t first_mult, std::size_t last_mult) noexcept -> std::size_t
+      {
+        auto first = static_cast<unsigned char>(word.front());
+        auto last  = static_cast<unsigned char>(word.back());
+        return (word.size() + first * first_mult + last * last_mult) & (TABLE_SIZE - 1);
       }
-      case 'e': {
-        switch (*(this->starting_char + 1)) {
-          case 'l': {
-            return this->check_keyword(2, 2, "se", Token::Type::ELSE);
-          }
-          case 'n': {
-            return this->check_keyword(2, 1, "d", Token::Type::END);
-          }
-          default:
-            return Token::Type::IDENTIFIER;
+
+      /**
+       * @brief Searches for the multipliers under which no two keywords share a slot
+       */
+      constexpr auto build() noexcept -> Table
+      {
+        Table table{};
+        table.min_length = LIST.front().name.size();
+        for (const auto& keyword : LIST) {
+          table.min_length = std::min(table.min_length, keyword.name.size());
+          table.max_length = std::max(table.max_length, keyword.name.size());
         }
-      }
-      case 'f': {
-        switch (*(this->starting_char + 1)) {
-          case 'a': {
-            return this->check_keyword(2, 3, "lse", Token::Type::FALSE);
-          }
-          case 'o': {
-            return this->check_keyword(2, 1, "r", Token::Type::FOR);
-          }
-          case 'n': {
-            return this->check_keyword(2, 0, "", Token::Type::FN);
+
+        for (std::size_t first_mult = 1; first_mult < TABLE_SIZE; first_mult++) {
+          for (std::size_t last_mult = 1; last_mult < TABLE_SIZE; last_mult++) {
+            std::array<bool, TABLE_SIZE> taken{};
+            bool collides = false;
+            for (const auto& keyword : LIST) {
+              std::size_t slot = hash(keyword.name, first_mult, last_mult);
+              collides         = collides || taken[slot];
+              taken[slot]      = true;
+            }
+            if (!collides) {
+              table.first_mult = first_mult;
+              table.last_mult  = last_mult;
+              for (const auto& keyword : LIST) { table.slots[hash(keyword.name, first_mult, last_mult)] = keyword; }
+              return table;
+            }
           }
-          default:
-            return Token::Type::IDENTIFIER;
         }
+
+        return table;
       }
-      case 'i': {
-        return this->check_keyword(1, 1, "f", Token::Type::IF);
-      }
-      case 'l':
-        switch (*(this->starting_char + 1)) {
-          case 'e':
-            return this->check_keyword(2, 1, "t", Token::Type::LET);
-          case 'o':
-            switch (*(this->starting_char + 2)) {
-              case 'a':
-                switch (*(this->starting_char + 3)) {
-                  case 'd': {
-                    auto type = this->check_keyword(4, 0, "", Token::Type::LOAD);
-                    if (type == Token::Type::LOAD) {
-                      return type;
-                    } else {
-                      switch (*(this->starting_char + 4)) {
-                        case 'r':
-                          return this->check_keyword(5, 0, "", Token::Type::LOADR);
-                        default:
-                          return Token::Type::IDENTIFIER;
-                      }
-                    }
-                  }
-                  default:
-                    return Token::Type::IDENTIFIER;
-                }
-              case 'o':
-                return this->check_keyword(3, 1, "p", Token::Type::LOOP);
-              default:
-                return Token::Type::IDENTIFIER;
-            }
-          default:
-            return Token::Type::IDENTIFIER;
+
+      constexpr Table TABLE = build();
+
+      static_assert(TABLE.first_mult != 0, "no perfect hash for the keywords, grow TABLE_SIZE");
+
+      /**
+       * @brief The keyword type of the word, IDENTIFIER if it is not one
+       */
+      constexpr auto lookup(std::string_view word) noexcept -> Token::Type
+      {
+        if (word.size() < TABLE.min_length || word.size() > TABLE.max_length) {
+          return Token::Type::IDENTIFIER;
         }
-      case 'm':
-        return this->check_keyword(1, 4, "atch", Token::Type::MATCH);
-      case 'n':
-        return this->check_keyword(1, 2, "il", Token::Type::NIL);
-      case 'o':
-        return this->check_keyword(1, 1, "r", Token::Type::OR);
-      case 'p':
-        return this->check_keyword(1, 4, "rint", Token::Type::PRINT);
-      case 'r':
-        return this->check_keyword(1, 2, "et", Token::Type::RETURN);
-      case 't':
-        return this->check_keyword(1, 3, "rue", Token::Type::TRUE);
-      case 'w':
-        return this->check_keyword(1, 4, "hile", Token::Type::WHILE);
-      default:
-        return Token::Type::IDENTIFIER;
-    }
-  }
 
-  auto Scanner::check_keyword(std::size_t start, std::size_t len, const char* rest, Token::Type type) const noexcept
-   -> Token::Type
+        const Keyword& candidate = TABLE.slots[hash(word, TABLE.first_mult, TABLE.last_mult)];
+        return candidate.name == word ? candidate.type : Token::Type::IDENTIFIER;
+      }
+
+      static_assert(lookup("loadr") == Token::Type::LOADR);
+      static_assert(lookup("loads") == Token::Type::IDENTIFIER);
+    }  // namespace
+  }  // namespace keywords
+
+  auto Scanner::make_identifier() -> Token
   {
-    if (
-     static_cast<std::size_t>(this->current_char - this->starting_char) == start + len &&
-     std::memcmp((this->starting_char + start).base(), rest, len) == 0) {
-      return type;
-    }
+    const char* from = this->current_char.base();
+    const char* to   = simd::skip(simd::CharClass::IDENTIFIER, from, this->source_end());
+
+    this->column += to - from;
+    this->current_char += to - from;
 
-    return Token::Type::IDENTIFIER;
+    return this->make_token(this->identifier());
+  }
+
+  auto Scanner::identifier() const noexcept -> Token::Type
+  {
+    return keywords::lookup(std::string_view(this->starting_char.base(), this->current_char - this->starting_char));
   }
 
   auto Scanner::is_at_end() const noexcept -> bool
@@ -521,83 +948,157 @@ namespace ss
 
   void Scanner::skip_whitespace() noexcept
   {
-    bool done = false;
-    while (!done && !this->is_at_end()) {
-      switch (this->peek()) {
-        case ' ':
-        case '\r':
-        case '\t': {
-          this->advance();
-        } break;
-        case '\n': {
-          this->line++;
-          this->column = 1;
-          this->advance();
-        } break;
-        case '#': {
-          while (!this->is_at_end() && this->advance() != '\n') {}
-        } break;
-        default: {
-          done = true;
-        }
+    const char* end = this->source_end();
+    for (;;) {
+      const char* from = this->current_char.base();
+      const char* to   = simd::skip(simd::CharClass::WHITESPACE, from, end);
+
+      if (std::size_t newlines = simd::count_newlines(from, to); newlines > 0) {
+        const char* last_newline = to - 1;
+        while (*last_newline != '\n') { last_newline--; }
+        this->line += newlines;
+        // the newline itself is column 1, what follows it starts at 2
+        this->column = 1 + (to - last_newline);
+      } else {
+        this->column += to - from;
+      }
+      this->current_char += to - from;
+
+      if (to == end || *to != '#') {
+        break;
       }
+
+      // comments end before the newline, which the next run of whitespace counts
+      const char* comment_end = simd::skip(simd::CharClass::COMMENT, to, end);
+      this->column += comment_end - to;
+      this->current_char += comment_end - to;
     }
     this->starting_char = this->current_char;
   }
 
+  auto Scanner::source_end() const noexcept -> const char*
+  {
+    return this->source.data() + this->source.size();
+  }
+
   auto Scanner::is_digit(char c) const noexcept -> bool
   {
     return !this->is_at_end() && c >= '0' && c <= '9';
   }
 
+  auto Scanner::is_hex_digit(char c) const noexcept -> bool
+  {
+    return this->is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+  }
+
+  auto Scanner::is_binary_digit(char c) const noexcept -> bool
+  {
+    return c == '0' || c == '1';
+  }
+
   auto Scanner::is_alpha(char c) const noexcept -> bool
   {
     return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '@';
   }
 
-  Parser::Parser(TokenList&& t, BytecodeChunk& c, std::string cf) noexcept
+  Parser::Parser(TokenList&& t, BytecodeChunk& c, std::string cf, bool lazy)
    : tokens(std::move(t))
-   , iter(this->tokens.begin())
    , chunk(c)
    , current_file(cf)
+   , file_index(c.add_file(this->current_file))
+   , lazy_functions(lazy)
+   , modules(nullptr)
+   , stats(nullptr)
+   , memory(this->tokens.resource())
+   , type_memory(this->memory)
+   , locals(this->memory)
    , scope_depth(0)
    , in_loop(false)
+   , breaks(this->memory)
+   , in_function(false)
+   , expr_type(StaticType::UNKNOWN)
+   , op_sites(this->memory)
+   , type_frames(this->memory)
+  {}
+
+  Parser::Parser(Scanner& scanner, BytecodeChunk& c, std::string cf, bool lazy)
+   : tokens(scanner)
+   , chunk(c)
+   , current_file(cf)
+   , file_index(c.add_file(this->current_file))
+   , lazy_functions(lazy)
+   , modules(nullptr)
+   , stats(nullptr)
+   , memory(this->tokens.resource())
+   , type_memory(this->memory)
+   , locals(this->memory)
+   , scope_depth(0)
+   , in_loop(false)
+   , breaks(this->memory)
+   , in_function(false)
+   , expr_type(StaticType::UNKNOWN)
+   , op_sites(this->memory)
+   , type_frames(this->memory)
   {}
 
   void Parser::parse()
   {
-    while (this->iter < tokens.end() && this->iter->type != Token::Type::END_OF_FILE) { this->declaration(); }
+    this->parse_module();
     this->emit_constant(Value{});
     this->emit_instruction(Instruction{OpCode::END});
   }
 
-  auto Parser::previous() const -> TokenIterator
+  void Parser::parse_module()
+  {
+    while (this->current().type != Token::Type::END_OF_FILE) { this->declaration(); }
+
+    if constexpr (PRINT_GENERIC_OPS) {
+      this->report_generic_ops();
+    }
+  }
+
+  void Parser::set_modules(ModuleLoader* loader) noexcept
+  {
+    this->modules = loader;
+  }
+
+  void Parser::set_stats(CompileStats* s) noexcept
   {
-    return this->iter - 1;
+    this->stats = s;
   }
 
-  void Parser::advance() noexcept
+  auto Parser::previous() const -> const Token&
   {
-    this->iter++;
+    return this->tokens.previous();
   }
 
-  void Parser::consume(Token::Type type, std::string err)
+  auto Parser::current() -> const Token&
   {
-    if (this->iter->type == type) {
+    return this->tokens.peek();
+  }
+
+  void Parser::advance()
+  {
+    this->tokens.advance();
+  }
+
+  void Parser::consume(Token::Type type, std::string_view err)
+  {
+    if (this->current().type == type) {
       this->advance();
     } else {
-      this->error(this->iter, err);
+      this->error(this->current(), err);
     }
   }
 
   void Parser::emit_instruction(Instruction i)
   {
-    this->chunk.write(i, this->previous()->line);
+    this->chunk.write(i, this->previous().line, this->previous().column, this->file_index);
   }
 
   void Parser::emit_constant(Value v)
   {
-    this->chunk.write_constant(v, this->previous()->line);
+    this->chunk.write_constant(v, this->previous().line, this->previous().column, this->file_index);
   }
 
   auto Parser::emit_jump(Instruction i) -> std::size_t
@@ -614,6 +1115,17 @@ namespace ss
     this->chunk.index_code_mut(jump_loc)->modifying_bits = offset;
   }
 
+  void Parser::emit_op(const Token& op, OpCode generic, OpCode typed, bool proven)
+  {
+    this->op_sites.push_back(OpSite{
+     .offset  = this->chunk.instruction_count(),
+     .generic = generic,
+     .typed   = proven,
+     .op      = op,
+    });
+    this->emit_instruction(Instruction{proven ? typed : generic});
+  }
+
   void Parser::wrap_scope(auto f)
   {
     this->scope_depth++;
@@ -640,7 +1152,8 @@ namespace ss
 
   void Parser::wrap_call_frame(auto f)
   {
-    auto old_locals = std::move(this->locals);
+    auto old_locals      = std::move(this->locals);
+    auto old_type_frames = std::move(this->type_frames);
 
     Local callable;
     callable.depth       = this->scope_depth;
@@ -651,7 +1164,8 @@ namespace ss
 
     this->locals.pop_back();
 
-    this->locals = std::move(old_locals);
+    this->locals      = std::move(old_locals);
+    this->type_frames = std::move(old_type_frames);
   }
 
   void Parser::wrap_call_block(std::size_t arg_count, auto f)
@@ -689,77 +1203,204 @@ namespace ss
     this->continue_jmp = old_continue;
   }
 
+  void Parser::wrap_invariants(auto f)
+  {
+    if (this->in_function) {
+      f();
+      return;
+    }
+
+    // the whole loop is buffered by now, peeking within it does not scan further
+    std::size_t end = this->find_loop_end();
+    this->tokens.peek(end);
+
+    std::pmr::unordered_set<std::string_view> excluded(this->memory);
+    std::pmr::unordered_set<std::string_view> seen(this->memory);
+    std::pmr::vector<Token> reads(this->memory);
+
+    bool in_params = false;
+    for (std::size_t i = 0; i < end; i++) {
+      const Token& tok = this->tokens.peek(i);
+      switch (tok.type) {
+        case Token::Type::LEFT_PAREN: {
+          // parameter list of a function declared inside the loop
+          in_params = i >= 2 && this->tokens.peek(i - 2).type == Token::Type::FN;
+        } break;
+        case Token::Type::RIGHT_PAREN: {
+          in_params = false;
+        } break;
+        case Token::Type::IDENTIFIER: {
+          Token::Type prev = i == 0 ? this->previous().type : this->tokens.peek(i - 1).type;
+          if (
+           in_params || prev == Token::Type::LET || prev == Token::Type::FN ||
+           this->tokens.peek(i + 1).type == Token::Type::EQUAL) {
+            excluded.insert(tok.lexeme);
+          } else if (seen.insert(tok.lexeme).second) {
+            reads.push_back(tok);
+          }
+        } break;
+        default:
+          break;
+      }
+    }
+
+    std::pmr::vector<Token> invariants(this->memory);
+    for (const auto& name : reads) {
+      if (
+       excluded.find(name.lexeme) == excluded.end() && !this->is_local(name) &&
+       this->chunk.is_global_defined(name.lexeme) && !this->chunk.is_global_assigned(name.lexeme)) {
+        invariants.push_back(name);
+      }
+    }
+
+    if (invariants.empty()) {
+      f();
+      return;
+    }
+
+    this->wrap_block([&] {
+      for (const auto& name : invariants) {
+        this->emit_instruction(Instruction{OpCode::LOOKUP_GLOBAL, this->identifier_constant(name)});
+        this->add_local(name);
+        this->locals.back().initialized = true;
+      }
+
+      f();
+    });
+  }
+
+  void Parser::wrap_loop_types(auto f)
+  {
+    this->type_frames.push_back(TypeFrame{
+     .first_site  = this->op_sites.size(),
+     .entry_types = this->snapshot_types(),
+     .assigned    = std::pmr::vector<std::size_t>(&this->type_memory),
+     .violated    = false,
+    });
+
+    f();
+
+    TypeFrame frame = std::move(this->type_frames.back());
+    this->type_frames.pop_back();
+
+    if (frame.violated) {
+      for (auto site = this->op_sites.begin() + frame.first_site; site < this->op_sites.end(); site++) {
+        if (site->typed) {
+          site->typed                                            = false;
+          this->chunk.index_code_mut(site->offset)->major_opcode = site->generic;
+        }
+      }
+
+      for (auto index : frame.assigned) {
+        if (index < this->locals.size()) {
+          this->assign_local_type(index, StaticType::UNKNOWN);
+        }
+      }
+    }
+
+    // the loop may not run at all, afterwards a local only has a type it had on entry
+    this->join_types(frame.entry_types);
+  }
+
+  consteval auto Parser::make_rules() -> RuleTable
+  {
+    RuleTable rules{};
+    std::array<bool, static_cast<std::size_t>(Token::Type::LAST)> given{};
+
+    auto rule = [&](Token::Type t, ParseRule r) {
+      auto index = static_cast<std::size_t>(t);
+      if (given[index]) {
+        throw "token type given more than one parse rule";
+      }
+      given[index] = true;
+      rules[index] = r;
+    };
+
+    rule(Token::Type::LEFT_PAREN,    {&Parser::grouping_expr, &Parser::call_expr, Precedence::CALL});
+    rule(Token::Type::RIGHT_PAREN,   {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::LEFT_BRACE,    {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::RIGHT_BRACE,   {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::COMMA,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::DOT,           {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::SEMICOLON,     {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::PLUS,          {nullptr, &Parser::binary_expr, Precedence::TERM});
+    rule(Token::Type::MINUS,         {&Parser::unary_expr, &Parser::binary_expr, Precedence::TERM});
+    rule(Token::Type::STAR,          {nullptr, &Parser::binary_expr, Precedence::FACTOR});
+    rule(Token::Type::SLASH,         {nullptr, &Parser::binary_expr, Precedence::FACTOR});
+    rule(Token::Type::MODULUS,       {nullptr, &Parser::binary_expr, Precedence::FACTOR});
+    rule(Token::Type::AMPERSAND,     {nullptr, &Parser::binary_expr, Precedence::BIT_AND});
+    rule(Token::Type::PIPE,          {nullptr, &Parser::binary_expr, Precedence::BIT_OR});
+    rule(Token::Type::CARET,         {nullptr, &Parser::binary_expr, Precedence::BIT_XOR});
+    rule(Token::Type::TILDE,         {&Parser::unary_expr, nullptr, Precedence::NONE});
+    rule(Token::Type::BANG,          {&Parser::unary_expr, nullptr, Precedence::NONE});
+    rule(Token::Type::BANG_EQUAL,    {nullptr, &Parser::binary_expr, Precedence::EQUALITY});
+    rule(Token::Type::EQUAL,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::EQUAL_EQUAL,   {nullptr, &Parser::binary_expr, Precedence::EQUALITY});
+    rule(Token::Type::GREATER,       {nullptr, &Parser::binary_expr, Precedence::COMPARISON});
+    rule(Token::Type::GREATER_EQUAL, {nullptr, &Parser::binary_expr, Precedence::COMPARISON});
+    rule(Token::Type::LESS,          {nullptr, &Parser::binary_expr, Precedence::COMPARISON});
+    rule(Token::Type::LESS_EQUAL,    {nullptr, &Parser::binary_expr, Precedence::COMPARISON});
+    rule(Token::Type::SHIFT_LEFT,    {nullptr, &Parser::binary_expr, Precedence::SHIFT});
+    rule(Token::Type::SHIFT_RIGHT,   {nullptr, &Parser::binary_expr, Precedence::SHIFT});
+    rule(Token::Type::ARROW,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::IDENTIFIER,    {&Parser::make_variable, nullptr, Precedence::NONE});
+    rule(Token::Type::STRING,        {&Parser::make_string, nullptr, Precedence::NONE});
+    rule(Token::Type::NUMBER,        {&Parser::make_number, nullptr, Precedence::NONE});
+    rule(Token::Type::AND,           {nullptr, &Parser::and_expr, Precedence::AND});
+    rule(Token::Type::BREAK,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::CLASS,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::CONTINUE,      {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::ELSE,          {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::END,           {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::FALSE,         {&Parser::literal_expr, nullptr, Precedence::NONE});
+    rule(Token::Type::FOR,           {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::FN,            {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::IF,            {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::LOAD,          {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::LOADR,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::LOOP,          {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::MATCH,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::NIL,           {&Parser::literal_expr, nullptr, Precedence::NONE});
+    rule(Token::Type::OR,            {nullptr, &Parser::or_expr, Precedence::OR});
+    rule(Token::Type::PRINT,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::RETURN,        {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::TRUE,          {&Parser::literal_expr, nullptr, Precedence::NONE});
+    rule(Token::Type::LET,           {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::WHILE,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::ERROR,         {nullptr, nullptr, Precedence::NONE});
+    rule(Token::Type::END_OF_FILE,   {nullptr, nullptr, Precedence::NONE});
+
+    for (bool g : given) {
+      if (!g) {
+        throw "token type without a parse rule";
+      }
+    }
+
+    return rules;
+  }
+
   auto Parser::rule_for(Token::Type t) const noexcept -> const ParseRule&
   {
-    static const std::array<ParseRule, static_cast<std::size_t>(Token::Type::LAST)> rules = [this] {
-      std::array<ParseRule, static_cast<std::size_t>(Token::Type::LAST)> rules{};
-      rules[static_cast<std::size_t>(Token::Type::LEFT_PAREN)] = {&Parser::grouping_expr, &Parser::call_expr, Precedence::CALL};
-      rules[static_cast<std::size_t>(Token::Type::RIGHT_PAREN)] = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::LEFT_BRACE)]  = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::RIGHT_BRACE)] = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::COMMA)]       = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::DOT)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::SEMICOLON)]   = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::PLUS)]        = {nullptr, &Parser::binary_expr, Precedence::TERM};
-      rules[static_cast<std::size_t>(Token::Type::MINUS)]       = {&Parser::unary_expr, &Parser::binary_expr, Precedence::TERM};
-      rules[static_cast<std::size_t>(Token::Type::STAR)]        = {nullptr, &Parser::binary_expr, Precedence::FACTOR};
-      rules[static_cast<std::size_t>(Token::Type::SLASH)]       = {nullptr, &Parser::binary_expr, Precedence::FACTOR};
-      rules[static_cast<std::size_t>(Token::Type::MODULUS)]     = {nullptr, &Parser::binary_expr, Precedence::FACTOR};
-      rules[static_cast<std::size_t>(Token::Type::BANG)]        = {&Parser::unary_expr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::BANG_EQUAL)]  = {nullptr, &Parser::binary_expr, Precedence::EQUALITY};
-      rules[static_cast<std::size_t>(Token::Type::EQUAL)]       = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::EQUAL_EQUAL)] = {nullptr, &Parser::binary_expr, Precedence::EQUALITY};
-      rules[static_cast<std::size_t>(Token::Type::GREATER)]     = {nullptr, &Parser::binary_expr, Precedence::COMPARISON};
-      rules[static_cast<std::size_t>(Token::Type::GREATER_EQUAL)] = {nullptr, &Parser::binary_expr, Precedence::COMPARISON};
-      rules[static_cast<std::size_t>(Token::Type::LESS)]          = {nullptr, &Parser::binary_expr, Precedence::COMPARISON};
-      rules[static_cast<std::size_t>(Token::Type::LESS_EQUAL)]    = {nullptr, &Parser::binary_expr, Precedence::COMPARISON};
-      rules[static_cast<std::size_t>(Token::Type::ARROW)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::IDENTIFIER)]    = {&Parser::make_variable, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::STRING)]        = {&Parser::make_string, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::NUMBER)]        = {&Parser::make_number, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::AND)]           = {nullptr, &Parser::and_expr, Precedence::AND};
-      rules[static_cast<std::size_t>(Token::Type::BREAK)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::CLASS)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::CONTINUE)]      = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::ELSE)]          = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::FALSE)]         = {&Parser::literal_expr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::FOR)]           = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::FN)]            = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::IF)]            = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::LOAD)]          = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::LOADR)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::LOOP)]          = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::MATCH)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::NIL)]           = {&Parser::literal_expr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::OR)]            = {nullptr, &Parser::or_expr, Precedence::OR};
-      rules[static_cast<std::size_t>(Token::Type::PRINT)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::RETURN)]        = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::TRUE)]          = {&Parser::literal_expr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::LET)]           = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::WHILE)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::ERROR)]         = {nullptr, nullptr, Precedence::NONE};
-      rules[static_cast<std::size_t>(Token::Type::END_OF_FILE)]   = {nullptr, nullptr, Precedence::NONE};
-      return rules;
-    }();
-
-    return rules[static_cast<std::size_t>(t)];
+    static constexpr RuleTable RULES = make_rules();
+
+    return RULES[static_cast<std::size_t>(t)];
   }
 
   void Parser::parse_precedence(Precedence precedence)
   {
     this->advance();
-    ParseFn prefix_rule = this->rule_for(this->previous()->type).prefix;
+    ParseFn prefix_rule = this->rule_for(this->previous().type).prefix;
     if (prefix_rule == nullptr) {
       this->error(this->previous(), "expected an expression");
     }
 
     bool can_assign = precedence <= Precedence::ASSIGNMENT;
-    prefix_rule(this, can_assign);
+    (this->*prefix_rule)(can_assign);
 
-    while (precedence <= this->rule_for(this->iter->type).precedence) {
+    while (precedence <= this->rule_for(this->current().type).precedence) {
       this->advance();
-      ParseFn infix_rule = this->rule_for(this->previous()->type).infix;
-      infix_rule(this, can_assign);
+      ParseFn infix_rule = this->rule_for(this->previous().type).infix;
+      (this->*infix_rule)(can_assign);
     }
 
     if (can_assign && this->advance_if_matches(Token::Type::EQUAL)) {
@@ -769,26 +1410,16 @@ namespace ss
 
   void Parser::make_number(bool)
   {
-    auto lexeme = this->previous()->lexeme;
-
-    const char* begin = lexeme.data();
-
-    // TODO when gcc finally has from_chars support for non-integrals
-    char* end = const_cast<char*>(lexeme.data()) + lexeme.size();
-
-    Value v = std::strtod(begin, &end);
-
-    if (end == begin) {
-      this->error(this->previous(), "unparsable number");
-    }
-
+    const Value& v = this->previous().value;
     this->emit_constant(v);
+    this->expr_type = v.is_type(Value::Type::Int) ? StaticType::INT : StaticType::NUMBER;
   }
 
   void Parser::make_string(bool)
   {
-    Value v(std::string(this->previous()->lexeme));
+    Value v = this->chunk.intern(this->previous().lexeme);
     this->emit_constant(v);
+    this->expr_type = StaticType::STRING;
   }
 
   void Parser::make_variable(bool can_assign)
@@ -798,7 +1429,70 @@ namespace ss
 
   void Parser::make_function(std::string name)
   {
+    if (this->lazy_functions) {
+      this->defer_function(std::move(name));
+      return;
+    }
+
     auto end_jmp       = this->emit_jump(Instruction{OpCode::JUMP});
+    std::size_t airity = this->function_body();
+
+    this->patch_jump(end_jmp);
+    this->emit_constant(Value{make_ref<Function>(name, airity, end_jmp)});
+  }
+
+  void Parser::defer_function(std::string name)
+  {
+    Token open = this->current();
+
+    this->consume(Token::Type::LEFT_PAREN, "expect '(' after function name");
+    std::size_t airity = 0;
+    if (!this->check(Token::Type::RIGHT_PAREN)) {
+      do {
+        airity++;
+        this->consume(Token::Type::IDENTIFIER, "expected parameter name");
+      } while (this->advance_if_matches(Token::Type::COMMA));
+    }
+    this->consume(Token::Type::RIGHT_PAREN, "expect ')' after parameters");
+    this->consume(Token::Type::LEFT_BRACE, "expect '{' before function body");
+
+    for (std::size_t depth = 1; depth > 0;) {
+      if (this->check(Token::Type::END_OF_FILE)) {
+        this->error(this->current(), "expect '}' after function body");
+      }
+      this->advance();
+      switch (this->previous().type) {
+        case Token::Type::LEFT_BRACE: {
+          depth++;
+        } break;
+        case Token::Type::RIGHT_BRACE: {
+          depth--;
+        } break;
+        case Token::Type::IDENTIFIER: {
+          // loops compiled before the first call must not cache globals the body assigns
+          if (this->check(Token::Type::EQUAL)) {
+            this->chunk.mark_global_assigned(this->previous().lexeme);
+          }
+        } break;
+        default:
+          break;
+      }
+    }
+
+    const char* end = this->previous().lexeme.data() + this->previous().lexeme.size();
+    this->emit_constant(Value{make_ref<Function>(
+     name,
+     airity,
+     Function::Source{
+      .text   = std::string(open.lexeme.data(), end),
+      .file   = this->current_file,
+      .line   = open.line,
+      .column = open.column,
+     })});
+  }
+
+  auto Parser::function_body() -> std::size_t
+  {
     std::size_t airity = 0;
 
     this->wrap_call_frame([&] {
@@ -841,11 +1535,26 @@ namespace ss
       this->locals.pop_back();
     });
 
-    this->patch_jump(end_jmp);
-    this->emit_constant(Value{std::make_shared<Function>(name, airity, end_jmp)});
+    return airity;
+  }
+
+  void Parser::parse_function(Function& fn)
+  {
+    // calls continue at the instruction after the entry point
+    std::size_t entry  = this->chunk.instruction_count() - 1;
+    std::size_t airity = this->function_body();
+
+    if (!this->check(Token::Type::END_OF_FILE)) {
+      this->error(this->current(), "unexpected tokens after the body of '", fn.name, "'");
+    }
+    if (airity != fn.airity) {
+      this->error(this->current(), "body of '", fn.name, "' does not match its declaration");
+    }
+
+    fn.instruction_ptr = entry;
   }
 
-  void Parser::named_variable(TokenIterator name, bool can_assign)
+  void Parser::named_variable(Token name, bool can_assign)
   {
     auto lookup = this->resolve_local(name);
 
@@ -859,20 +1568,27 @@ namespace ss
       get   = OpCode::LOOKUP_GLOBAL;
       set   = OpCode::ASSIGN_GLOBAL;
       index = this->identifier_constant(name);
+      if (can_assign && this->check(Token::Type::EQUAL)) {
+        this->chunk.mark_global_assigned(name.lexeme);
+      }
     } else {
       // impossible for now
-      this->error(name, "invalid lookup type for var '", name->lexeme, "'");
+      this->error(name, "invalid lookup type for var '", name.lexeme, "'");
     }
 
     if (can_assign && this->advance_if_matches(Token::Type::EQUAL)) {
       this->expression();
       this->emit_instruction(Instruction{set, index});
+      if (lookup.type == VarLookup::Type::LOCAL) {
+        this->assign_local_type(index, this->expr_type);
+      }
     } else {
       this->emit_instruction(Instruction{get, index});
+      this->expr_type = lookup.type == VarLookup::Type::LOCAL ? this->locals[index].type : StaticType::UNKNOWN;
     }
   }
 
-  auto Parser::parse_variable(std::string err_msg) -> std::size_t
+  auto Parser::parse_variable(std::string_view err_msg) -> std::size_t
   {
     this->consume(Token::Type::IDENTIFIER, err_msg);
     this->declare_variable();
@@ -896,6 +1612,7 @@ namespace ss
   {
     if (this->scope_depth == 0) {
       this->emit_instruction(Instruction{OpCode::DEFINE_GLOBAL, global});
+      this->chunk.mark_global_defined(this->chunk.constant_at(global).string());
     } else {
       this->locals.back().initialized = true;
     }
@@ -904,13 +1621,13 @@ namespace ss
   void Parser::declare_variable()
   {
     if (this->scope_depth > 0) {
-      auto name = this->previous();
+      Token name = this->previous();
       for (auto local = this->locals.rbegin(); local != this->locals.rend(); local++) {
         if (local->initialized && local->depth < this->scope_depth) {
           break;
         }
 
-        if (name->lexeme == local->name.lexeme) {
+        if (name.lexeme == local->name.lexeme) {
           this->error(name, "variable with same name already delcared in scope");
         }
       }
@@ -918,19 +1635,19 @@ namespace ss
     }
   }
 
-  auto Parser::identifier_constant(TokenIterator name) -> std::size_t
+  auto Parser::identifier_constant(const Token& name) -> std::size_t
   {
-    auto entry = this->chunk.find_ident(name->lexeme);
-    if (this->chunk.is_entry_found(entry)) {
-      return entry->second;
+    auto entry = this->chunk.find_ident(name.lexeme);
+    if (entry) {
+      return *entry;
     } else {
-      return this->chunk.add_ident(name->lexeme);
+      return this->chunk.add_ident(name.lexeme);
     }
   }
 
   auto Parser::check(Token::Type type) -> bool
   {
-    return this->iter->type == type;
+    return this->current().type == type;
   }
 
   auto Parser::advance_if_matches(Token::Type type) -> bool
@@ -943,20 +1660,20 @@ namespace ss
     return true;
   }
 
-  void Parser::add_local(TokenIterator name) noexcept
+  void Parser::add_local(const Token& name) noexcept
   {
     Local local;
-    local.name        = *name;
+    local.name        = name;
     local.depth       = this->scope_depth;
     local.initialized = false;
     this->locals.push_back(local);
   }
 
-  auto Parser::resolve_local(TokenIterator name) const -> VarLookup
+  auto Parser::resolve_local(const Token& name) const -> VarLookup
   {
     std::size_t index = this->locals.size() - 1;
     for (auto local = this->locals.rbegin(); local != this->locals.rend(); local++, index--) {
-      if (name->lexeme == local->name.lexeme) {
+      if (name.lexeme == local->name.lexeme) {
         if (!local->initialized) {
           this->error(name, "can't read variable in it's own initializer");
         }
@@ -973,14 +1690,89 @@ namespace ss
     };
   }
 
-  auto Parser::reduce_locals_to_depth(std::size_t depth) -> std::size_t
+  auto Parser::is_local(const Token& name) const noexcept -> bool
+  {
+    for (const auto& local : this->locals) {
+      if (name.lexeme == local.name.lexeme) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  auto Parser::find_loop_end() -> std::size_t
+  {
+    std::size_t tok = 0;
+    for (Token::Type t = this->tokens.peek(tok).type; t != Token::Type::LEFT_BRACE && t != Token::Type::END_OF_FILE;) {
+      t = this->tokens.peek(++tok).type;
+    }
+
+    std::size_t depth = 0;
+    for (Token::Type t = this->tokens.peek(tok).type; t != Token::Type::END_OF_FILE; t = this->tokens.peek(++tok).type) {
+      if (t == Token::Type::LEFT_BRACE) {
+        depth++;
+      } else if (t == Token::Type::RIGHT_BRACE && --depth == 0) {
+        return tok + 1;
+      }
+    }
+
+    return tok;
+  }
+
+  auto Parser::reduce_locals_to_depth(std::size_t depth) -> std::size_t
+  {
+    std::size_t count = 0;
+    while (!this->locals.empty() && this->locals.back().depth > depth) {
+      this->locals.pop_back();
+      count++;
+    }
+    return count;
+  }
+
+  void Parser::assign_local_type(std::size_t index, StaticType type)
+  {
+    this->locals[index].type = type;
+
+    for (auto& frame : this->type_frames) {
+      if (index < frame.entry_types.size()) {
+        frame.assigned.push_back(index);
+        if (frame.entry_types[index] != StaticType::UNKNOWN && frame.entry_types[index] != type) {
+          frame.violated = true;
+        }
+      }
+    }
+  }
+
+  auto Parser::snapshot_types() -> TypeList
+  {
+    TypeList types(&this->type_memory);
+    types.reserve(this->locals.size());
+    for (const auto& local : this->locals) { types.push_back(local.type); }
+    return types;
+  }
+
+  void Parser::restore_types(const TypeList& types)
+  {
+    for (std::size_t i = 0; i < types.size() && i < this->locals.size(); i++) { this->locals[i].type = types[i]; }
+  }
+
+  void Parser::join_types(const TypeList& types)
+  {
+    for (std::size_t i = 0; i < types.size() && i < this->locals.size(); i++) {
+      if (this->locals[i].type != types[i]) {
+        this->assign_local_type(i, StaticType::UNKNOWN);
+      }
+    }
+  }
+
+  void Parser::report_generic_ops() const
   {
-    std::size_t count = 0;
-    while (!this->locals.empty() && this->locals.back().depth > depth) {
-      this->locals.pop_back();
-      count++;
+    for (const auto& site : this->op_sites) {
+      if (!site.typed) {
+        VMConfig::basic.write_line(
+         this->current_file, ':', site.op.line, ':', site.op.column, " -> generic ", site.generic, " '", site.op.lexeme, '\'');
+      }
     }
-    return count;
   }
 
   void Parser::expression()
@@ -996,16 +1788,27 @@ namespace ss
 
   void Parser::unary_expr(bool)
   {
-    Token::Type operator_type = this->previous()->type;
+    Token op                  = this->previous();
+    Token::Type operator_type = op.type;
 
     this->parse_precedence(Precedence::UNARY);
 
     switch (operator_type) {
       case Token::Type::BANG: {
         this->emit_instruction(Instruction{OpCode::NOT});
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::MINUS: {
-        this->emit_instruction(Instruction{OpCode::NEGATE});
+        bool is_int = this->expr_type == StaticType::INT;
+        this->emit_op(
+         op, OpCode::NEGATE, is_int ? OpCode::NEGATE_INT : OpCode::NEGATE_NUM, is_int || this->expr_type == StaticType::NUMBER);
+        if (!is_int && this->expr_type != StaticType::NUMBER) {
+          this->expr_type = StaticType::UNKNOWN;
+        }
+      } break;
+      case Token::Type::TILDE: {
+        this->emit_instruction(Instruction{OpCode::BIT_NOT});
+        this->expr_type = StaticType::INT;
       } break;
       default:  // unreachable
         this->error(this->previous(), "invalid unary operator");
@@ -1014,44 +1817,101 @@ namespace ss
 
   void Parser::binary_expr(bool)
   {
-    Token::Type operator_type = this->previous()->type;
+    Token op                  = this->previous();
+    Token::Type operator_type = op.type;
+    StaticType lhs            = this->expr_type;
 
     const ParseRule& rule = this->rule_for(operator_type);
     this->parse_precedence(static_cast<Precedence>(static_cast<std::size_t>(rule.precedence) + 1));
 
+    StaticType rhs = this->expr_type;
+    bool ints      = lhs == StaticType::INT && rhs == StaticType::INT;
+    bool numbers   = lhs == StaticType::NUMBER && rhs == StaticType::NUMBER;
+    bool stringy   = lhs == StaticType::STRING || rhs == StaticType::STRING;
+
+    // integers promote to numbers when mixed
+    auto is_numeric   = [](StaticType t) { return t == StaticType::INT || t == StaticType::NUMBER; };
+    StaticType arith  = ints ? StaticType::INT : is_numeric(lhs) && is_numeric(rhs) ? StaticType::NUMBER : StaticType::UNKNOWN;
+    auto typed        = [ints](OpCode num, OpCode integer) { return ints ? integer : num; };
+    bool proven       = ints || numbers;
+
     switch (operator_type) {
       case Token::Type::EQUAL_EQUAL: {
-        this->emit_instruction(Instruction{OpCode::EQUAL});
+        this->emit_op(op, OpCode::EQUAL, typed(OpCode::EQUAL_NUM, OpCode::EQUAL_INT), proven);
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::BANG_EQUAL: {
-        this->emit_instruction(Instruction{OpCode::NOT_EQUAL});
+        this->emit_op(op, OpCode::NOT_EQUAL, typed(OpCode::NOT_EQUAL_NUM, OpCode::NOT_EQUAL_INT), proven);
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::GREATER: {
-        this->emit_instruction(Instruction{OpCode::GREATER});
+        this->emit_op(op, OpCode::GREATER, typed(OpCode::GREATER_NUM, OpCode::GREATER_INT), proven);
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::GREATER_EQUAL: {
-        this->emit_instruction(Instruction{OpCode::GREATER_EQUAL});
+        this->emit_op(op, OpCode::GREATER_EQUAL, typed(OpCode::GREATER_EQUAL_NUM, OpCode::GREATER_EQUAL_INT), proven);
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::LESS: {
-        this->emit_instruction(Instruction{OpCode::LESS});
+        this->emit_op(op, OpCode::LESS, typed(OpCode::LESS_NUM, OpCode::LESS_INT), proven);
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::LESS_EQUAL: {
-        this->emit_instruction(Instruction{OpCode::LESS_EQUAL});
+        this->emit_op(op, OpCode::LESS_EQUAL, typed(OpCode::LESS_EQUAL_NUM, OpCode::LESS_EQUAL_INT), proven);
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::PLUS: {
-        this->emit_instruction(Instruction{OpCode::ADD});
+        if (stringy) {
+          // everything after this in the + chain appends to a string, so the whole chain is joined at once
+          std::size_t count = 2;
+          while (this->advance_if_matches(Token::Type::PLUS)) {
+            this->parse_precedence(static_cast<Precedence>(static_cast<std::size_t>(rule.precedence) + 1));
+            count++;
+          }
+          this->emit_instruction(Instruction{OpCode::CONCAT_N, count});
+          this->expr_type = StaticType::STRING;
+        } else {
+          this->emit_op(op, OpCode::ADD, typed(OpCode::ADD_NUM, OpCode::ADD_INT), proven);
+          this->expr_type = arith;
+        }
       } break;
       case Token::Type::MINUS: {
-        this->emit_instruction(Instruction{OpCode::SUB});
+        this->emit_op(op, OpCode::SUB, typed(OpCode::SUB_NUM, OpCode::SUB_INT), proven);
+        this->expr_type = arith;
       } break;
       case Token::Type::STAR: {
-        this->emit_instruction(Instruction{OpCode::MUL});
+        this->emit_op(op, OpCode::MUL, typed(OpCode::MUL_NUM, OpCode::MUL_INT), proven);
+        this->expr_type = arith != StaticType::UNKNOWN ? arith : stringy ? StaticType::STRING : StaticType::UNKNOWN;
       } break;
       case Token::Type::SLASH: {
-        this->emit_instruction(Instruction{OpCode::DIV});
+        // integer division is only exact sometimes, so only numbers have a typed instruction
+        this->emit_op(op, OpCode::DIV, OpCode::DIV_NUM, numbers);
+        this->expr_type = arith == StaticType::NUMBER ? StaticType::NUMBER : StaticType::UNKNOWN;
       } break;
       case Token::Type::MODULUS: {
-        this->emit_instruction(Instruction{OpCode::MOD});
+        // an integer remainder by zero is NaN, so only numbers give a known type
+        this->emit_op(op, OpCode::MOD, typed(OpCode::MOD_NUM, OpCode::MOD_INT), proven);
+        this->expr_type = arith == StaticType::NUMBER ? StaticType::NUMBER : StaticType::UNKNOWN;
+      } break;
+      case Token::Type::AMPERSAND: {
+        this->emit_instruction(Instruction{OpCode::BIT_AND});
+        this->expr_type = StaticType::INT;
+      } break;
+      case Token::Type::PIPE: {
+        this->emit_instruction(Instruction{OpCode::BIT_OR});
+        this->expr_type = StaticType::INT;
+      } break;
+      case Token::Type::CARET: {
+        this->emit_instruction(Instruction{OpCode::BIT_XOR});
+        this->expr_type = StaticType::INT;
+      } break;
+      case Token::Type::SHIFT_LEFT: {
+        this->emit_instruction(Instruction{OpCode::SHIFT_LEFT});
+        this->expr_type = StaticType::INT;
+      } break;
+      case Token::Type::SHIFT_RIGHT: {
+        this->emit_instruction(Instruction{OpCode::SHIFT_RIGHT});
+        this->expr_type = StaticType::INT;
       } break;
       default: {
         // unreachable
@@ -1062,15 +1922,18 @@ namespace ss
 
   void Parser::literal_expr(bool)
   {
-    switch (this->previous()->type) {
+    switch (this->previous().type) {
       case Token::Type::NIL: {
         this->emit_instruction(Instruction{OpCode::NIL});
+        this->expr_type = StaticType::NIL;
       } break;
       case Token::Type::TRUE: {
         this->emit_instruction(Instruction{OpCode::TRUE});
+        this->expr_type = StaticType::BOOL;
       } break;
       case Token::Type::FALSE: {
         this->emit_instruction(Instruction{OpCode::FALSE});
+        this->expr_type = StaticType::BOOL;
       } break;
       default: {
         // unreachable
@@ -1081,16 +1944,24 @@ namespace ss
 
   void Parser::and_expr(bool)
   {
+    StaticType lhs      = this->expr_type;
+    auto types          = this->snapshot_types();
     std::size_t end_jmp = this->emit_jump(Instruction{OpCode::AND});
     this->parse_precedence(Precedence::AND);
     this->patch_jump(end_jmp);
+    this->join_types(types);
+    this->expr_type = lhs == this->expr_type ? lhs : StaticType::UNKNOWN;
   }
 
   void Parser::or_expr(bool)
   {
+    StaticType lhs      = this->expr_type;
+    auto types          = this->snapshot_types();
     std::size_t end_jmp = this->emit_jump(Instruction{OpCode::OR});
     this->parse_precedence(Precedence::OR);
     this->patch_jump(end_jmp);
+    this->join_types(types);
+    this->expr_type = lhs == this->expr_type ? lhs : StaticType::UNKNOWN;
   }
 
   void Parser::call_expr(bool)
@@ -1099,11 +1970,12 @@ namespace ss
     this->emit_instruction(Instruction{OpCode::PUSH_SP, arg_count});
     this->emit_constant(Value{Value::AddressType{this->chunk.instruction_count() + 2}});
     this->emit_instruction(Instruction{OpCode::CALL, arg_count});
+    this->expr_type = StaticType::UNKNOWN;
   }
 
   void Parser::statement()
   {
-    switch (this->iter->type) {
+    switch (this->current().type) {
       case Token::Type::BREAK: {
         this->advance();
         this->break_stmt();
@@ -1122,7 +1994,7 @@ namespace ss
       } break;
       case Token::Type::FOR: {
         this->advance();
-        this->for_stmt();
+        this->wrap_invariants([&] { this->for_stmt(); });
       } break;
       case Token::Type::IF: {
         this->advance();
@@ -1142,7 +2014,7 @@ namespace ss
       } break;
       case Token::Type::LOOP: {
         this->advance();
-        this->loop_stmt();
+        this->wrap_invariants([&] { this->loop_stmt(); });
       } break;
       case Token::Type::MATCH: {
         this->advance();
@@ -1158,7 +2030,7 @@ namespace ss
       } break;
       case Token::Type::WHILE: {
         this->advance();
-        this->while_stmt();
+        this->wrap_invariants([&] { this->while_stmt(); });
       } break;
       default: {
         this->expression_stmt();
@@ -1193,14 +2065,20 @@ namespace ss
   {
     std::size_t global = this->parse_variable("expect variable name");
 
+    StaticType type = StaticType::NIL;
     if (this->advance_if_matches(Token::Type::EQUAL)) {
       this->expression();
+      type = this->expr_type;
     } else {
       this->emit_instruction(Instruction{OpCode::NIL});
     }
     this->consume(Token::Type::SEMICOLON, "expect ';' after variable declaration");
 
     this->define_variable(global);
+
+    if (this->scope_depth > 0) {
+      this->locals.back().type = type;
+    }
   }
 
   void Parser::block_stmt()
@@ -1224,10 +2102,15 @@ namespace ss
     this->expression();
     this->consume(Token::Type::LEFT_BRACE, "expect '{' after condition");
 
+    auto types = this->snapshot_types();
+
     std::size_t jump_location = this->emit_jump(Instruction{OpCode::JUMP_IF_FALSE});
     this->emit_instruction(Instruction{OpCode::POP});
     this->block_stmt();
 
+    auto then_types = this->snapshot_types();
+    this->restore_types(types);
+
     std::size_t else_location = this->emit_jump(Instruction{OpCode::JUMP});
     this->patch_jump(jump_location);
     this->emit_instruction(Instruction{OpCode::POP});
@@ -1236,6 +2119,8 @@ namespace ss
       this->statement();
     }
 
+    this->join_types(then_types);
+
     this->patch_jump(else_location);
   }
 
@@ -1243,10 +2128,12 @@ namespace ss
   {
     std::size_t loop_start = this->chunk.instruction_count();
     this->consume(Token::Type::LEFT_BRACE, "expect '{' after loop keyword");
-    this->wrap_loop(loop_start, [&] {
-      this->block_stmt();
-      this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
-      for (const auto jmp : this->breaks) { this->patch_jump(jmp); }
+    this->wrap_loop_types([&] {
+      this->wrap_loop(loop_start, [&] {
+        this->block_stmt();
+        this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
+        for (const auto jmp : this->breaks) { this->patch_jump(jmp); }
+      });
     });
   }
 
@@ -1254,20 +2141,22 @@ namespace ss
   {
     std::size_t loop_start = this->chunk.instruction_count();
 
-    this->expression();
-    this->consume(Token::Type::LEFT_BRACE, "expect '{' after condition");
+    this->wrap_loop_types([&] {
+      this->expression();
+      this->consume(Token::Type::LEFT_BRACE, "expect '{' after condition");
 
-    std::size_t exit_jmp = this->emit_jump(Instruction{OpCode::JUMP_IF_FALSE});
+      std::size_t exit_jmp = this->emit_jump(Instruction{OpCode::JUMP_IF_FALSE});
 
-    this->emit_instruction(Instruction{OpCode::POP});
-    this->wrap_loop(loop_start, [&] {
-      this->block_stmt();
+      this->emit_instruction(Instruction{OpCode::POP});
+      this->wrap_loop(loop_start, [&] {
+        this->block_stmt();
 
-      this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
+        this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
 
-      this->patch_jump(exit_jmp);
-      this->emit_instruction(Instruction{OpCode::POP});
-      for (const auto jmp : this->breaks) { this->patch_jump(jmp); }
+        this->patch_jump(exit_jmp);
+        this->emit_instruction(Instruction{OpCode::POP});
+        for (const auto jmp : this->breaks) { this->patch_jump(jmp); }
+      });
     });
   }
 
@@ -1284,42 +2173,44 @@ namespace ss
 
       std::size_t loop_start = this->chunk.instruction_count();
 
-      bool has_exit = false;
-      std::size_t exit_jmp;
+      this->wrap_loop_types([&] {
+        bool has_exit = false;
+        std::size_t exit_jmp;
 
-      if (!this->advance_if_matches(Token::Type::SEMICOLON)) {
-        this->expression();
-        this->consume(Token::Type::SEMICOLON, "expect ';'");
+        if (!this->advance_if_matches(Token::Type::SEMICOLON)) {
+          this->expression();
+          this->consume(Token::Type::SEMICOLON, "expect ';'");
 
-        has_exit = true;
-        exit_jmp = this->emit_jump(Instruction{OpCode::JUMP_IF_FALSE});
-        this->emit_instruction(Instruction{OpCode::POP});
-      }
+          has_exit = true;
+          exit_jmp = this->emit_jump(Instruction{OpCode::JUMP_IF_FALSE});
+          this->emit_instruction(Instruction{OpCode::POP});
+        }
 
-      // TODO consider pushing instructions to a separate vector and sticking them after the block stmt
-      if (!this->advance_if_matches(Token::Type::LEFT_BRACE)) {
-        std::size_t body_jmp = this->emit_jump(Instruction{OpCode::JUMP});
+        // TODO consider pushing instructions to a separate vector and sticking them after the block stmt
+        if (!this->advance_if_matches(Token::Type::LEFT_BRACE)) {
+          std::size_t body_jmp = this->emit_jump(Instruction{OpCode::JUMP});
 
-        std::size_t increment_start = this->chunk.instruction_count();
-        this->expression();
-        this->emit_instruction(Instruction{OpCode::POP});
-        this->consume(Token::Type::LEFT_BRACE, "expect '}' after clauses");
+          std::size_t increment_start = this->chunk.instruction_count();
+          this->expression();
+          this->emit_instruction(Instruction{OpCode::POP});
+          this->consume(Token::Type::LEFT_BRACE, "expect '}' after clauses");
 
-        this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
-        loop_start = increment_start;
-        this->patch_jump(body_jmp);
-      }
+          this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
+          loop_start = increment_start;
+          this->patch_jump(body_jmp);
+        }
 
-      this->wrap_loop(loop_start, [&] {
-        this->block_stmt();
+        this->wrap_loop(loop_start, [&] {
+          this->block_stmt();
 
-        this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
+          this->emit_instruction(Instruction{OpCode::LOOP, this->chunk.instruction_count() - loop_start});
 
-        if (has_exit) {
-          this->patch_jump(exit_jmp);
-          this->emit_instruction(Instruction{OpCode::POP});
-          for (const auto jmp : this->breaks) { this->patch_jump(jmp); }
-        }
+          if (has_exit) {
+            this->patch_jump(exit_jmp);
+            this->emit_instruction(Instruction{OpCode::POP});
+            for (const auto jmp : this->breaks) { this->patch_jump(jmp); }
+          }
+        });
       });
     });
   }
@@ -1333,8 +2224,10 @@ namespace ss
       this->expression();
       this->consume(Token::Type::ARROW, "expect '=>' after expression");
       this->emit_instruction(Instruction{OpCode::CHECK});
+      auto types           = this->snapshot_types();
       std::size_t next_jmp = this->emit_jump(Instruction{OpCode::JUMP_IF_FALSE});
       this->statement();
+      this->join_types(types);
       this->patch_jump(next_jmp);
       this->emit_instruction(Instruction{OpCode::POP});
     }
@@ -1409,13 +2302,451 @@ namespace ss
   void Parser::load_stmt()
   {
     if (this->scope_depth != 0) {
-      this->error(this->iter, "can only load files in global scope");
+      this->error(this->current(), "can only load files in global scope");
+    }
+    this->consume(Token::Type::STRING, "expected file to be string type");
+    auto file = this->previous().lexeme;
+    this->consume(Token::Type::SEMICOLON, "expected ';' after load stmt");
+
+    auto paths = ModuleLoader::library_paths(file);
+    if (paths.empty()) {
+      this->error(this->previous(), "unable to load file");
+    }
+
+    for (const auto& path : paths) { this->load_module(path); }
+  }
+
+  void Parser::loadr_stmt()
+  {
+    if (this->scope_depth != 0) {
+      this->error(this->current(), "can only load files in global scope");
     }
     this->consume(Token::Type::STRING, "expected file to be string type");
-    auto file = this->previous()->lexeme;
+    auto file = this->previous().lexeme;
     this->consume(Token::Type::SEMICOLON, "expected ';' after load stmt");
-    auto libdirs    = std::getenv("SS_LIB");
-    bool file_found = false;
+
+    auto path = ModuleLoader::relative_path(this->current_file, file);
+    if (!std::filesystem::exists(path) && !bytecode::has_fresh(path)) {
+      this->error(this->previous(), "unable to load file");
+    }
+
+    this->load_module(path);
+  }
+
+  void Parser::load_module(const std::string& path)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    // nothing else adds to the list while the file loads, the pointer stays valid
+    CompileStats* module_stats = this->stats == nullptr ? nullptr : &this->stats->modules.emplace_back();
+
+    // the loader skips files with fresh bytecode
+    auto module = this->modules == nullptr ? nullptr : this->modules->take(path, module_stats);
+    if (module != nullptr) {
+      this->chunk.link(std::move(*module));
+    } else if (bytecode::has_fresh(path)) {
+      std::ifstream ifs(bytecode::compiled_path(path), std::ios::binary);
+      bytecode::read(ifs, this->chunk);
+      if (module_stats != nullptr) {
+        module_stats->file          = path;
+        module_stats->from_bytecode = true;
+      }
+    } else {
+      std::ifstream ifs(path);
+      auto contents = util::stream_to_string(ifs);
+      if (module_stats != nullptr) {
+        module_stats->read = std::chrono::steady_clock::now() - start;
+      }
+
+      Compiler compiler(this->lazy_functions);
+      compiler.compile_module(std::move(contents), this->chunk, path, nullptr, module_stats);
+    }
+
+    if (this->stats != nullptr) {
+      this->stats->load += std::chrono::steady_clock::now() - start;
+    }
+  }
+
+  void Parser::fn_stmt()
+  {
+    auto global = this->parse_variable("expected function name");
+    if (this->scope_depth > 0) {
+      this->locals.back().initialized = true;
+    }
+    this->make_function(std::string(this->previous().lexeme));
+    this->define_variable(global);
+  }
+
+  RegisterTranslator::RegisterTranslator(BytecodeChunk& c) noexcept
+   : chunk(c)
+  {}
+
+  void RegisterTranslator::translate(std::size_t offset)
+  {
+    this->find_targets(offset);
+
+    std::size_t count = this->chunk.instruction_count();
+    auto code         = this->chunk.begin();
+
+    for (std::size_t i = offset; i + 2 < count; i++) {
+      RegisterOperands::Source lhs, rhs;
+      if (this->is_target(i + 1) || this->is_target(i + 2) || !this->source_of(code[i], lhs)) {
+        continue;
+      }
+
+      Instruction second = code[i + 1];
+      Instruction third  = code[i + 2];
+
+      if (this->source_of(second, rhs) && is_binary(third.major_opcode)) {
+        // LOAD lhs; LOAD rhs; BINOP; [ASSIGN_LOCAL dest; POP]
+        std::size_t dest = RegisterOperands::PUSH;
+        if (
+         i + 4 < count && !this->is_target(i + 3) && !this->is_target(i + 4) &&
+         code[i + 3].major_opcode == OpCode::ASSIGN_LOCAL && code[i + 3].modifying_bits <= RegisterOperands::MAX_INDEX &&
+         code[i + 4].major_opcode == OpCode::POP) {
+          dest = code[i + 3].modifying_bits;
+        }
+
+        code[i] = Instruction{
+         OpCode::BINARY_R,
+         RegisterOperands{third.major_opcode, dest, lhs, rhs}.pack(),
+        };
+      } else if (
+       second.major_opcode == OpCode::ASSIGN_LOCAL && second.modifying_bits <= RegisterOperands::MAX_INDEX &&
+       third.major_opcode == OpCode::POP) {
+        // LOAD src; ASSIGN_LOCAL dest; POP
+        code[i] = Instruction{
+         OpCode::MOVE_R,
+         RegisterOperands{OpCode::MOVE_R, second.modifying_bits, lhs, lhs}.pack(),
+        };
+      } else {
+        continue;
+      }
+
+      i += length_of(code[i]) - 1;
+    }
+  }
+
+  void RegisterTranslator::find_targets(std::size_t offset)
+  {
+    std::size_t count = this->chunk.instruction_count();
+    this->targets.assign(count + 1, false);
+    this->targets[offset] = true;
+
+    auto mark = [&](std::size_t target) {
+      if (target < this->targets.size()) {
+        this->targets[target] = true;
+      }
+    };
+
+    for (std::size_t i = 0; i < count; i++) {
+      Instruction instruction = *this->chunk.index_code_mut(i);
+      switch (instruction.major_opcode) {
+        case OpCode::JUMP:
+        case OpCode::JUMP_IF_FALSE:
+        case OpCode::OR:
+        case OpCode::AND: {
+          mark(i + instruction.modifying_bits);
+        } break;
+        case OpCode::LOOP: {
+          mark(i - instruction.modifying_bits);
+        } break;
+        case OpCode::CONSTANT: {
+          const Value& constant = this->chunk.constant_ref(instruction.modifying_bits);
+          if (constant.is_type(Value::Type::Function) && constant.function()->is_compiled()) {
+            // calls resume at the instruction after the function's entry point
+            mark(constant.function()->instruction_ptr + 1);
+          } else if (constant.is_type(Value::Type::Address)) {
+            mark(constant.address().ptr);
+          }
+        } break;
+        default:
+          break;
+      }
+    }
+  }
+
+  auto RegisterTranslator::is_target(std::size_t index) const noexcept -> bool
+  {
+    return this->targets[index];
+  }
+
+  auto RegisterTranslator::source_of(Instruction i, RegisterOperands::Source& src) const noexcept -> bool
+  {
+    if (i.modifying_bits > RegisterOperands::MAX_INDEX) {
+      return false;
+    }
+
+    switch (i.major_opcode) {
+      case OpCode::LOOKUP_LOCAL: {
+        src = RegisterOperands::Source{false, i.modifying_bits};
+      } break;
+      case OpCode::CONSTANT: {
+        src = RegisterOperands::Source{true, i.modifying_bits};
+      } break;
+      default: {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  auto RegisterTranslator::is_binary(OpCode op) noexcept -> bool
+  {
+    switch (op) {
+      case OpCode::EQUAL:
+      case OpCode::NOT_EQUAL:
+      case OpCode::GREATER:
+      case OpCode::GREATER_EQUAL:
+      case OpCode::LESS:
+      case OpCode::LESS_EQUAL:
+      case OpCode::ADD:
+      case OpCode::SUB:
+      case OpCode::MUL:
+      case OpCode::DIV:
+      case OpCode::MOD:
+      case OpCode::EQUAL_NUM:
+      case OpCode::NOT_EQUAL_NUM:
+      case OpCode::GREATER_NUM:
+      case OpCode::GREATER_EQUAL_NUM:
+      case OpCode::LESS_NUM:
+      case OpCode::LESS_EQUAL_NUM:
+      case OpCode::ADD_NUM:
+      case OpCode::SUB_NUM:
+      case OpCode::MUL_NUM:
+      case OpCode::DIV_NUM:
+      case OpCode::MOD_NUM:
+      case OpCode::EQUAL_INT:
+      case OpCode::NOT_EQUAL_INT:
+      case OpCode::GREATER_INT:
+      case OpCode::GREATER_EQUAL_INT:
+      case OpCode::LESS_INT:
+      case OpCode::LESS_EQUAL_INT:
+      case OpCode::ADD_INT:
+      case OpCode::SUB_INT:
+      case OpCode::MUL_INT:
+      case OpCode::MOD_INT:
+      case OpCode::BIT_AND:
+      case OpCode::BIT_OR:
+      case OpCode::BIT_XOR:
+      case OpCode::SHIFT_LEFT:
+      case OpCode::SHIFT_RIGHT: {
+        return true;
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+
+  namespace
+  {
+    void print_stats(std::ostream& ostream, const CompileStats& stats, std::size_t depth)
+    {
+      auto ms = [](std::chrono::nanoseconds time) { return std::chrono::duration<double, std::milli>(time).count(); };
+
+      std::string indent(depth * 2, ' ');
+      ostream << indent << stats.file << ": " << ms(stats.total) << " ms, " << stats.bytes << " bytes, " << stats.tokens
+              << " tokens, " << stats.instructions << " instructions, " << stats.constants << " constants\n";
+      ostream << indent << "  read " << ms(stats.read) << " ms, prefetch " << ms(stats.prefetch) << " ms, scan "
+              << ms(stats.scan) << " ms, parse " << ms(stats.parse) << " ms, load " << ms(stats.load) << " ms, translate "
+              << ms(stats.translate) << " ms\n";
+
+      for (const auto& module : stats.modules) { print_stats(ostream, module, depth + 1); }
+    }
+
+    void add_loaded_file(std::vector<std::string>& files, std::string file)
+    {
+      if (std::find(files.begin(), files.end(), file) == files.end()) {
+        files.push_back(std::move(file));
+      }
+    }
+
+    void collect_loaded_files(const CompileStats& stats, std::vector<std::string>& files)
+    {
+      for (const auto& module : stats.modules) {
+        add_loaded_file(files, module.file);
+        if (module.from_bytecode) {
+          add_loaded_file(files, bytecode::compiled_path(module.file));
+          for (auto& file : bytecode::dependencies(module.file)) { add_loaded_file(files, std::move(file)); }
+        }
+        collect_loaded_files(module, files);
+      }
+    }
+  }  // namespace
+
+  auto operator<<(std::ostream& ostream, const CompileStats& stats) -> std::ostream&
+  {
+    print_stats(ostream, stats, 0);
+    return ostream;
+  }
+
+  auto loaded_files(const CompileStats& stats) -> std::vector<std::string>
+  {
+    std::vector<std::string> files;
+    collect_loaded_files(stats, files);
+    return files;
+  }
+
+  Compiler::Compiler(bool lazy, std::size_t threads) noexcept
+   : lazy_functions(lazy)
+   , module_threads(threads)
+  {}
+
+  void Compiler::compile(std::string&& src, BytecodeChunk& chunk, std::string current_file, CompileStats* stats)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<ModuleLoader> modules;
+    if (this->module_threads > 0) {
+      modules = std::make_unique<ModuleLoader>(this->lazy_functions, this->module_threads, stats != nullptr);
+      modules->prefetch(src, current_file);
+    }
+
+    if (stats != nullptr) {
+      stats->prefetch = std::chrono::steady_clock::now() - start;
+    }
+
+    this->run(std::move(src), chunk, std::move(current_file), modules.get(), stats, false);
+
+    if (stats != nullptr) {
+      stats->total = std::chrono::steady_clock::now() - start;
+    }
+  }
+
+  void Compiler::compile_module(
+   std::string&& src, BytecodeChunk& chunk, std::string current_file, ModuleLoader* modules, CompileStats* stats)
+  {
+    this->run(std::move(src), chunk, std::move(current_file), modules, stats, true);
+  }
+
+  void Compiler::run(std::string&& src,
+   BytecodeChunk& chunk,
+   std::string current_file,
+   ModuleLoader* modules,
+   CompileStats* stats,
+   bool module)
+  {
+    util::Arena arena;
+
+    std::size_t bytes = src.size();
+    Scanner scanner(std::move(src), &arena);
+
+    auto parse = [&](Parser& parser) {
+      parser.set_modules(modules);
+      parser.set_stats(stats);
+      if (module) {
+        parser.parse_module();
+      } else {
+        parser.parse();
+      }
+    };
+
+    if (stats == nullptr) {
+      Parser parser(scanner, chunk, current_file, this->lazy_functions);
+      parse(parser);
+      return;
+    }
+
+    std::size_t first_instruction = chunk.instruction_count();
+    std::size_t first_constant    = chunk.constant_count();
+
+    auto start   = std::chrono::steady_clock::now();
+    auto tokens  = scanner.scan();
+    auto scanned = std::chrono::steady_clock::now();
+
+    stats->file   = current_file;
+    stats->bytes  = bytes;
+    stats->tokens = tokens.size();
+
+    {
+      Parser parser(std::move(tokens), chunk, current_file, this->lazy_functions);
+      parse(parser);
+    }
+
+    auto parsed = std::chrono::steady_clock::now();
+
+    stats->scan         = scanned - start;
+    stats->parse        = parsed - scanned - stats->load;
+    stats->total        = parsed - start;
+    stats->instructions = chunk.instruction_count() - first_instruction;
+    stats->constants    = chunk.constant_count() - first_constant;
+  }
+
+  void Compiler::compile_function(Function& fn, BytecodeChunk& chunk)
+  {
+    util::Arena arena;
+
+    // the source stays with the function until the body compiled, should it fail the next call tries again
+    std::string text = fn.source->text;
+    Scanner scanner(std::move(text), &arena, fn.source->line, fn.source->column);
+
+    Parser parser(scanner, chunk, fn.source->file, this->lazy_functions);
+
+    parser.parse_function(fn);
+
+    fn.source.reset();
+  }
+
+  ModuleLoader::ModuleLoader(bool lazy, std::size_t threads, bool collect)
+   : lazy_functions(lazy)
+   , thread_count(std::max<std::size_t>(threads, 1))
+   , collect_stats(collect)
+   , next_job(0)
+  {}
+
+  ModuleLoader::~ModuleLoader()
+  {
+    // whatever is left is not wanted anymore, the script failed to compile
+    this->next_job = this->jobs.size();
+    for (auto& worker : this->workers) { worker.join(); }
+  }
+
+  void ModuleLoader::prefetch(std::string& src, const std::string& current_file)
+  {
+    std::vector<std::string> ancestors;
+    this->scan_loads(src, current_file, ancestors);
+
+    for (auto& job : this->jobs) {
+      job->chunk = std::make_unique<BytecodeChunk>();
+      for (const auto& name : this->assigned) { job->chunk->mark_global_assigned(name); }
+    }
+
+    std::size_t count = std::min(this->thread_count, this->jobs.size());
+    for (std::size_t i = 0; i < count; i++) { this->workers.emplace_back([this] { this->work(); }); }
+  }
+
+  auto ModuleLoader::take(const std::string& path, CompileStats* stats) -> std::unique_ptr<BytecodeChunk>
+  {
+    Job* job = nullptr;
+    {
+      std::lock_guard guard(this->lock);
+      auto entry = this->untaken.find(path);
+      if (entry == this->untaken.end() || entry->second.empty()) {
+        return nullptr;
+      }
+      job = entry->second.front();
+      entry->second.pop_front();
+    }
+
+    // nothing picked the job up yet, waiting for the pool could take longer than doing it
+    this->run(*job);
+
+    std::unique_lock guard(this->lock);
+    this->finished.wait(guard, [job] { return job->state == State::DONE; });
+    if (job->error) {
+      std::rethrow_exception(job->error);
+    }
+    if (stats != nullptr) {
+      *stats = std::move(job->stats);
+    }
+    return std::move(job->chunk);
+  }
+
+  auto ModuleLoader::library_paths(std::string_view file) -> std::vector<std::string>
+  {
+    auto libdirs = std::getenv("SS_LIB");
 
     std::string dirs;
     if (libdirs == nullptr) {
@@ -1429,69 +2760,118 @@ namespace ss
       dirs = libdirs;
     }
 
+    std::vector<std::string> paths;
     std::istringstream iss(dirs);
     std::string line;
     while (std::getline(iss, line, ':')) {
       std::stringstream ss;
       ss << line << '/' << file;
       std::string path = ss.str();
-      if (std::filesystem::exists(path)) {
-        std::ifstream ifs(path);
-        auto contents = util::stream_to_string(ifs);
-
-        Compiler compiler;
-        compiler.compile(std::move(contents), this->chunk, path);
-        file_found = true;
+      if (std::filesystem::exists(path) || bytecode::has_fresh(path)) {
+        paths.push_back(std::move(path));
       }
     }
 
-    if (!file_found) {
-      this->error(this->previous(), "unable to load file");
-    }
+    return paths;
   }
 
-  void Parser::loadr_stmt()
+  auto ModuleLoader::relative_path(std::string_view current_file, std::string_view file) -> std::string
   {
-    if (this->scope_depth != 0) {
-      this->error(this->iter, "can only load files in global scope");
-    }
-    this->consume(Token::Type::STRING, "expected file to be string type");
-    auto file = this->previous()->lexeme;
-    this->consume(Token::Type::SEMICOLON, "expected ';' after load stmt");
-    std::filesystem::path path = this->current_file;
+    std::filesystem::path path = current_file;
     std::stringstream ss;
     ss << path.parent_path().string() << '/' << file;
-    path = ss.str();
-
-    if (!std::filesystem::exists(path)) {
-      this->error(this->previous(), "unable to load file");
+    return ss.str();
+  }
+
+  void ModuleLoader::scan_loads(std::string& src, const std::string& current_file, std::vector<std::string>& ancestors)
+  {
+    std::vector<std::string> paths;
+    {
+      Scanner scanner(std::move(src));
+      std::size_t depth           = 0;
+      Token::Type before_previous = Token::Type::END_OF_FILE;
+      Token previous{Token::Type::END_OF_FILE, "", 0, 0};
+      for (Token token = scanner.next(); token.type != Token::Type::END_OF_FILE; token = scanner.next()) {
+        switch (token.type) {
+          case Token::Type::LEFT_BRACE: {
+            depth++;
+          } break;
+          case Token::Type::RIGHT_BRACE: {
+            depth -= depth > 0;
+          } break;
+          case Token::Type::EQUAL: {
+            if (previous.type == Token::Type::IDENTIFIER && before_previous != Token::Type::LET) {
+              this->assigned.emplace(previous.lexeme);
+            }
+          } break;
+          case Token::Type::STRING: {
+            // loads anywhere else are an error the parser reports
+            if (depth == 0 && previous.type == Token::Type::LOAD) {
+              for (auto& path : library_paths(token.lexeme)) { paths.push_back(std::move(path)); }
+            } else if (depth == 0 && previous.type == Token::Type::LOADR) {
+              auto path = relative_path(current_file, token.lexeme);
+              if (std::filesystem::exists(path) || bytecode::has_fresh(path)) {
+                paths.push_back(std::move(path));
+              }
+            }
+          } break;
+          default:
+            break;
+        }
+        before_previous = previous.type;
+        previous        = token;
+      }
     }
 
-    std::ifstream ifs(path.string());
-    auto contents = util::stream_to_string(ifs);
+    ancestors.push_back(current_file);
+    for (auto& path : paths) {
+      // compiled files hold what they load already
+      if (std::find(ancestors.begin(), ancestors.end(), path) != ancestors.end() || bytecode::has_fresh(path)) {
+        continue;
+      }
 
-    Compiler compiler;
-    compiler.compile(std::move(contents), this->chunk, path.string());
-  }
+      auto start = std::chrono::steady_clock::now();
+      auto job   = std::make_unique<Job>();
+      job->path  = path;
+      std::ifstream ifs(path);
+      job->source     = util::stream_to_string(ifs);
+      job->stats.read = std::chrono::steady_clock::now() - start;
 
-  void Parser::fn_stmt()
-  {
-    auto global = this->parse_variable("expected function name");
-    if (this->scope_depth > 0) {
-      this->locals.back().initialized = true;
+      Job& queued = *job;
+      this->untaken[path].push_back(&queued);
+      this->jobs.push_back(std::move(job));
+
+      this->scan_loads(queued.source, path, ancestors);
     }
-    this->make_function(std::string(this->previous()->lexeme));
-    this->define_variable(global);
+    ancestors.pop_back();
   }
 
-  void Compiler::compile(std::string&& src, BytecodeChunk& chunk, std::string current_file)
+  void ModuleLoader::work()
   {
-    Scanner scanner(std::move(src));
+    for (std::size_t i = this->next_job++; i < this->jobs.size(); i = this->next_job++) { this->run(*this->jobs[i]); }
+  }
 
-    auto tokens = scanner.scan();
+  void ModuleLoader::run(Job& job)
+  {
+    {
+      std::lock_guard guard(this->lock);
+      if (job.state != State::PENDING) {
+        return;
+      }
+      job.state = State::RUNNING;
+    }
 
-    Parser parser(std::move(tokens), chunk, current_file);
+    try {
+      Compiler compiler(this->lazy_functions);
+      compiler.compile_module(std::move(job.source), *job.chunk, job.path, this, this->collect_stats ? &job.stats : nullptr);
+    } catch (...) {
+      job.error = std::current_exception();
+    }
 
-    parser.parse();
+    {
+      std::lock_guard guard(this->lock);
+      job.state = State::DONE;
+    }
+    this->finished.notify_all();
   }
 }  // namespace ss
\ No newline at end of file
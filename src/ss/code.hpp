@@ -3,10 +3,28 @@
 #include "cfg.hpp"
 #include "datatypes.hpp"
 #include "exceptions.hpp"
+#include "memory.hpp"
+#include "util.hpp"
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <iosfwd>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 /**
@@ -129,6 +147,139 @@ namespace ss
      * @brief Pops a value off the stack, inverts its numarical value, then pushes that back on
      */
     NEGATE,
+    /**
+     * @brief Pops two integers off the stack, calculates the bitwise and, then pushes the result back on
+     */
+    BIT_AND,
+    /**
+     * @brief Pops two integers off the stack, calculates the bitwise or, then pushes the result back on
+     */
+    BIT_OR,
+    /**
+     * @brief Pops two integers off the stack, calculates the bitwise xor, then pushes the result back on
+     */
+    BIT_XOR,
+    /**
+     * @brief Pops an integer off the stack, inverts its bits, then pushes that back on
+     */
+    BIT_NOT,
+    /**
+     * @brief Pops two integers off the stack, shifts the first left by the second, then pushes the result back on
+     */
+    SHIFT_LEFT,
+    /**
+     * @brief Pops two integers off the stack, shifts the first right by the second keeping the sign, then pushes the result
+     * back on
+     */
+    SHIFT_RIGHT,
+    /**
+     * @brief Pops N values off the stack, joins them into one string, then pushes the result back on. N is specified by the
+     * modifying bits. Behaves the same as adding the values left to right
+     */
+    CONCAT_N,
+    /**
+     * @brief Same as EQUAL, but both values are known to be numbers at compile time
+     */
+    EQUAL_NUM,
+    /**
+     * @brief Same as NOT_EQUAL, but both values are known to be numbers at compile time
+     */
+    NOT_EQUAL_NUM,
+    /**
+     * @brief Same as GREATER, but both values are known to be numbers at compile time
+     */
+    GREATER_NUM,
+    /**
+     * @brief Same as GREATER_EQUAL, but both values are known to be numbers at compile time
+     */
+    GREATER_EQUAL_NUM,
+    /**
+     * @brief Same as LESS, but both values are known to be numbers at compile time
+     */
+    LESS_NUM,
+    /**
+     * @brief Same as LESS_EQUAL, but both values are known to be numbers at compile time
+     */
+    LESS_EQUAL_NUM,
+    /**
+     * @brief Same as ADD, but both values are known to be numbers at compile time
+     */
+    ADD_NUM,
+    /**
+     * @brief Same as SUB, but both values are known to be numbers at compile time
+     */
+    SUB_NUM,
+    /**
+     * @brief Same as MUL, but both values are known to be numbers at compile time
+     */
+    MUL_NUM,
+    /**
+     * @brief Same as DIV, but both values are known to be numbers at compile time
+     */
+    DIV_NUM,
+    /**
+     * @brief Same as MOD, but both values are known to be numbers at compile time
+     */
+    MOD_NUM,
+    /**
+     * @brief Same as NEGATE, but the value is known to be a number at compile time
+     */
+    NEGATE_NUM,
+    /**
+     * @brief Same as EQUAL, but both values are known to be integers at compile time
+     */
+    EQUAL_INT,
+    /**
+     * @brief Same as NOT_EQUAL, but both values are known to be integers at compile time
+     */
+    NOT_EQUAL_INT,
+    /**
+     * @brief Same as GREATER, but both values are known to be integers at compile time
+     */
+    GREATER_INT,
+    /**
+     * @brief Same as GREATER_EQUAL, but both values are known to be integers at compile time
+     */
+    GREATER_EQUAL_INT,
+    /**
+     * @brief Same as LESS, but both values are known to be integers at compile time
+     */
+    LESS_INT,
+    /**
+     * @brief Same as LESS_EQUAL, but both values are known to be integers at compile time
+     */
+    LESS_EQUAL_INT,
+    /**
+     * @brief Same as ADD, but both values are known to be integers at compile time
+     */
+    ADD_INT,
+    /**
+     * @brief Same as SUB, but both values are known to be integers at compile time
+     */
+    SUB_INT,
+    /**
+     * @brief Same as MUL, but both values are known to be integers at compile time
+     */
+    MUL_INT,
+    /**
+     * @brief Same as MOD, but both values are known to be integers at compile time. The result is not, it is NaN when
+     * dividing by zero
+     */
+    MOD_INT,
+    /**
+     * @brief Same as NEGATE, but the value is known to be an integer at compile time
+     */
+    NEGATE_INT,
+    /**
+     * @brief Register backend only. Applies a binary operator to two registers or constants, storing the result in a
+     * register or pushing it. The operands are specified by the modifying bits, see RegisterOperands
+     */
+    BINARY_R,
+    /**
+     * @brief Register backend only. Copies a register or constant into a register. The operands are specified by the
+     * modifying bits, see RegisterOperands
+     */
+    MOVE_R,
     /**
      * @brief Pops a value off the stack and prints it to the screen
      */
@@ -209,6 +360,38 @@ namespace ss
       SS_ENUM_TO_STR_CASE(OpCode, MOD)
       SS_ENUM_TO_STR_CASE(OpCode, NOT)
       SS_ENUM_TO_STR_CASE(OpCode, NEGATE)
+      SS_ENUM_TO_STR_CASE(OpCode, BIT_AND)
+      SS_ENUM_TO_STR_CASE(OpCode, BIT_OR)
+      SS_ENUM_TO_STR_CASE(OpCode, BIT_XOR)
+      SS_ENUM_TO_STR_CASE(OpCode, BIT_NOT)
+      SS_ENUM_TO_STR_CASE(OpCode, SHIFT_LEFT)
+      SS_ENUM_TO_STR_CASE(OpCode, SHIFT_RIGHT)
+      SS_ENUM_TO_STR_CASE(OpCode, CONCAT_N)
+      SS_ENUM_TO_STR_CASE(OpCode, EQUAL_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, NOT_EQUAL_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, GREATER_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, GREATER_EQUAL_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, LESS_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, LESS_EQUAL_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, ADD_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, SUB_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, MUL_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, DIV_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, MOD_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, NEGATE_NUM)
+      SS_ENUM_TO_STR_CASE(OpCode, EQUAL_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, NOT_EQUAL_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, GREATER_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, GREATER_EQUAL_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, LESS_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, LESS_EQUAL_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, ADD_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, SUB_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, MUL_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, MOD_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, NEGATE_INT)
+      SS_ENUM_TO_STR_CASE(OpCode, BINARY_R)
+      SS_ENUM_TO_STR_CASE(OpCode, MOVE_R)
       SS_ENUM_TO_STR_CASE(OpCode, PRINT)
       SS_ENUM_TO_STR_CASE(OpCode, SWAP)
       SS_ENUM_TO_STR_CASE(OpCode, MOVE)
@@ -229,6 +412,69 @@ namespace ss
 
   auto operator<<(std::ostream& ostream, const OpCode& code) -> std::ostream&;
 
+  /**
+   * @brief Operands of a register instruction, packed into the modifying bits.
+   *
+   * Registers are the slots of the current call frame, indexed the same way as LOOKUP_LOCAL. Sources can also index the
+   * constant list. The destination can be the top of the stack instead of a register
+   */
+  struct RegisterOperands
+  {
+    static constexpr std::size_t INDEX_BITS  = 18;
+    static constexpr std::size_t SOURCE_BITS = INDEX_BITS + 1;
+    static constexpr std::size_t INDEX_MASK  = (std::size_t{1} << INDEX_BITS) - 1;
+    static constexpr std::size_t SOURCE_MASK = (std::size_t{1} << SOURCE_BITS) - 1;
+    /**
+     * @brief Destination meaning the result is pushed onto the stack
+     */
+    static constexpr std::size_t PUSH = INDEX_MASK;
+    /**
+     * @brief Largest register or constant index that can be encoded
+     */
+    static constexpr std::size_t MAX_INDEX = INDEX_MASK - 1;
+
+    struct Source
+    {
+      bool constant;
+      std::size_t index;
+    };
+
+    OpCode op;
+    std::size_t dest;
+    Source lhs;
+    Source rhs;
+
+    constexpr auto pack() const noexcept -> std::size_t
+    {
+      return static_cast<std::size_t>(this->op) | (this->dest << 8) | (pack_source(this->lhs) << (8 + INDEX_BITS))
+           | (pack_source(this->rhs) << (8 + INDEX_BITS + SOURCE_BITS));
+    }
+
+    static constexpr auto unpack(std::size_t bits) noexcept -> RegisterOperands
+    {
+      return RegisterOperands{
+       .op   = static_cast<OpCode>(bits & 0xff),
+       .dest = (bits >> 8) & INDEX_MASK,
+       .lhs  = unpack_source((bits >> (8 + INDEX_BITS)) & SOURCE_MASK),
+       .rhs  = unpack_source((bits >> (8 + INDEX_BITS + SOURCE_BITS)) & SOURCE_MASK),
+      };
+    }
+
+   private:
+    static constexpr auto pack_source(Source src) noexcept -> std::size_t
+    {
+      return (src.index << 1) | (src.constant ? 1 : 0);
+    }
+
+    static constexpr auto unpack_source(std::size_t bits) noexcept -> Source
+    {
+      return Source{
+       .constant = (bits & 1) == 1,
+       .index    = bits >> 1,
+      };
+    }
+  };
+
   /**
    * @brief Structure representing scanned tokens
    */
@@ -252,6 +498,10 @@ namespace ss
       STAR,
       SLASH,
       MODULUS,
+      AMPERSAND,
+      PIPE,
+      CARET,
+      TILDE,
 
       // One or two character tokens.
       BANG,
@@ -262,6 +512,8 @@ namespace ss
       GREATER_EQUAL,
       LESS,
       LESS_EQUAL,
+      SHIFT_LEFT,
+      SHIFT_RIGHT,
       ARROW,
 
       // Literals.
@@ -301,6 +553,10 @@ namespace ss
     std::string_view lexeme;
     std::size_t line;
     std::size_t column;
+    /**
+     * @brief The parsed value of number literals, nil for every other token
+     */
+    Value value = Value();
 
     auto operator==(const Token& other) const noexcept -> bool;
   };
@@ -320,6 +576,10 @@ namespace ss
       SS_ENUM_TO_STR_CASE(Token::Type, STAR)
       SS_ENUM_TO_STR_CASE(Token::Type, SLASH)
       SS_ENUM_TO_STR_CASE(Token::Type, MODULUS)
+      SS_ENUM_TO_STR_CASE(Token::Type, AMPERSAND)
+      SS_ENUM_TO_STR_CASE(Token::Type, PIPE)
+      SS_ENUM_TO_STR_CASE(Token::Type, CARET)
+      SS_ENUM_TO_STR_CASE(Token::Type, TILDE)
       SS_ENUM_TO_STR_CASE(Token::Type, BANG)
       SS_ENUM_TO_STR_CASE(Token::Type, BANG_EQUAL)
       SS_ENUM_TO_STR_CASE(Token::Type, EQUAL)
@@ -328,6 +588,8 @@ namespace ss
       SS_ENUM_TO_STR_CASE(Token::Type, GREATER_EQUAL)
       SS_ENUM_TO_STR_CASE(Token::Type, LESS)
       SS_ENUM_TO_STR_CASE(Token::Type, LESS_EQUAL)
+      SS_ENUM_TO_STR_CASE(Token::Type, SHIFT_LEFT)
+      SS_ENUM_TO_STR_CASE(Token::Type, SHIFT_RIGHT)
       SS_ENUM_TO_STR_CASE(Token::Type, IDENTIFIER)
       SS_ENUM_TO_STR_CASE(Token::Type, STRING)
       SS_ENUM_TO_STR_CASE(Token::Type, NUMBER)
@@ -363,38 +625,185 @@ namespace ss
   auto operator<<(std::ostream& ostream, const Token::Type& type) -> std::ostream&;
   auto operator<<(std::ostream& ostream, const Token& token) -> std::ostream&;
 
+  using TokenList = std::pmr::vector<Token>;
+
+  /**
+   * @brief Where an instruction was compiled from
+   */
+  struct SourceLocation
+  {
+    std::string_view file;
+    std::size_t line;
+    std::size_t column;
+  };
+
+  /**
+   * @brief Where the time compiling one file went, filled in when asked for
+   */
+  struct CompileStats
+  {
+    std::string file;
+    /**
+     * @brief Reading the file, zero for sources handed over in memory
+     */
+    std::chrono::nanoseconds read{0};
+    /**
+     * @brief Finding the files the script loads and starting to compile them, when that is done ahead of time
+     */
+    std::chrono::nanoseconds prefetch{0};
+    std::chrono::nanoseconds scan{0};
+    /**
+     * @brief Parsing and emitting code, without the files loaded along the way
+     */
+    std::chrono::nanoseconds parse{0};
+    /**
+     * @brief Compiling the files loaded along the way, or waiting for them, and linking them in
+     */
+    std::chrono::nanoseconds load{0};
+    /**
+     * @brief Translating to the register instruction set, only done for the script itself
+     */
+    std::chrono::nanoseconds translate{0};
+    /**
+     * @brief Everything but reading the file
+     */
+    std::chrono::nanoseconds total{0};
+    std::size_t bytes  = 0;
+    std::size_t tokens = 0;
+    /**
+     * @brief Instructions and constants added to the chunk, the loaded files' included
+     */
+    std::size_t instructions = 0;
+    std::size_t constants    = 0;
+    /**
+     * @brief Whether the file was read from its .ssc rather than compiled, the files it loads are then not listed
+     */
+    bool from_bytecode = false;
+    /**
+     * @brief The loaded files, in the order they were loaded
+     */
+    std::vector<CompileStats> modules;
+  };
+
+  /**
+   * @brief Prints the stats of the file followed by those of the files it loaded, indented under it
+   */
+  auto operator<<(std::ostream& ostream, const CompileStats& stats) -> std::ostream&;
+
+  /**
+   * @brief Every file the code depends on besides the one compiled, each once. For files read as bytecode that is the
+   * .ssc and the files linked into it
+   */
+  auto loaded_files(const CompileStats& stats) -> std::vector<std::string>;
+
+  /**
+   * @brief Compiled code along with what running it needs. Everything only used to compile more code into the chunk or to
+   * describe it lives in a separate DebugInfo, made on first use, that can be detached once compilation is done
+   */
   class BytecodeChunk
   {
    public:
     using Instructions        = std::vector<Instruction>;
     using InstructionIterator = Instructions::iterator;
+    using ValueStack          = std::vector<Value, TrackingAllocator<Value, MemoryTracker::Category::STACK>>;
+    using ConstantList        = std::vector<Value, TrackingAllocator<Value, MemoryTracker::Category::CONSTANTS>>;
+
+    using GlobalMap = std::unordered_map<
+     Value::StringType,
+     Value,
+     util::StringHash,
+     std::equal_to<>,
+     TrackingAllocator<std::pair<const Value::StringType, Value>, MemoryTracker::Category::GLOBALS>>;
+    using GlobalNameSet = std::unordered_set<Value::StringType, util::StringHash, std::equal_to<>>;
+    using InternTable   = std::unordered_map<
+     std::string_view,
+     Value::StringObjectType,
+     std::hash<std::string_view>,
+     std::equal_to<std::string_view>,
+     TrackingAllocator<std::pair<const std::string_view, Value::StringObjectType>, MemoryTracker::Category::STRINGS>>;
+    using LocalCache      = std::unordered_map<std::size_t, std::string>;
+    using IdentifierCache = std::unordered_map<std::string_view, std::size_t>;
+
+    /**
+     * @brief Metadata never touched by running code. Without it locations are unknown and identifiers compiled afterwards
+     * get new constants instead of sharing the existing ones
+     */
+    struct DebugInfo
+    {
+      /**
+       * @brief Consecutive instructions written from the same line of the same file
+       */
+      struct LineRun
+      {
+        std::uint32_t first_instruction;
+        std::uint32_t line;
+        std::uint32_t column;
+        std::uint32_t file;
+      };
 
-    using GlobalMap            = std::unordered_map<Value::StringType, Value>;
-    using LocalCache           = std::unordered_map<std::size_t, std::string>;
-    using IdentifierCache      = std::unordered_map<std::string_view, std::size_t>;
-    using IdentifierCacheEntry = IdentifierCache::const_iterator;
+      /**
+       * @brief Sorted by their first instruction, a new run starts whenever the line or file changes
+       */
+      std::vector<LineRun> lines;
+      std::vector<std::string> files;
+      /**
+       * @brief Constant indices of identifier names, keyed on the interned strings the constants hold
+       */
+      IdentifierCache identifier_cache;
+    };
 
     /**
-     * @brief Prepares the chunk for a new script, however globals remain intact
+     * @brief Everything compiling a script puts into the chunk, enough to run the script again without compiling it
+     */
+    struct Program
+    {
+      Instructions code;
+      std::vector<Value> constants;
+      std::optional<DebugInfo> debug;
+      GlobalNameSet defined_globals;
+      /**
+       * @brief Globals assigned to by the code compiled into the chunk by the time the script was. Invariant globals are
+       * hoisted out of loops based on them, code assigning to more of them makes the program stale
+       */
+      GlobalNameSet assigned_globals;
+    };
+
+    /**
+     * @param memory Where the stack, constants, globals and interned strings are charged to, if anywhere
+     */
+    explicit BytecodeChunk(MemoryTracker* memory = nullptr) noexcept;
+
+    /**
+     * @brief Prepares the chunk for a new script, however globals remain intact. Interned strings nothing else refers to
+     * are dropped
      */
     void prepare() noexcept;
 
     /**
-     * @brief Writes the instruction and tags it with the line
+     * @brief Writes the instruction and tags it with where it came from
+     *
+     * @param file Index returned by add_file, 0 is the first file added or an unnamed one if none was
+     */
+    void write(Instruction, std::size_t line, std::size_t column = 0, std::size_t file = 0);
+
+    /**
+     * @brief Writes a constant instruction and tags the instruction with where it came from
      */
-    void write(Instruction, std::size_t line) noexcept;
+    void write_constant(Value v, std::size_t line, std::size_t column = 0, std::size_t file = 0);
 
     /**
-     * @brief Writes a constant instruction and tags the instruction with the line
+     * @brief Registers a source file that code is written from
+     *
+     * @return The index to tag instructions with, the same one every time for the same name
      */
-    void write_constant(Value v, std::size_t line) noexcept;
+    auto add_file(std::string_view name) -> std::size_t;
 
     /**
      * @brief Writes a constant to the constant buffer
      *
      * @return The offset of the newly inserted constant
      */
-    auto insert_constant(Value v) noexcept -> std::size_t;
+    auto insert_constant(Value v) -> std::size_t;
 
     /**
      * @brief Acquires the constant at the given index
@@ -403,10 +812,19 @@ namespace ss
      */
     auto constant_at(std::size_t offset) const noexcept -> Value;
 
+    /**
+     * @brief Acquires the constant at the given index without copying it
+     *
+     * @return A reference to the value at the offset
+     */
+    auto constant_ref(std::size_t offset) const noexcept -> const Value&;
+
+    auto constant_count() const noexcept -> std::size_t;
+
     /**
      * @brief Pushes a new value onto the stack
      */
-    void push_stack(Value v) noexcept;
+    void push_stack(Value v);
 
     /**
      * @brief Pops a value off the stack
@@ -458,30 +876,77 @@ namespace ss
     /**
      * @brief Grabs the line at the given offset
      *
-     * @return The line number
+     * @return The line number, 0 if the offset is before any written instruction
      */
     auto line_at(std::size_t offset) const noexcept -> std::size_t;
 
+    /**
+     * @brief Grabs the file, line and column of the instruction at the given offset. The column is that of the first
+     * instruction on the line. The file name is valid until the next file is added
+     */
+    auto location_at(std::size_t offset) const noexcept -> SourceLocation;
+
     auto instruction_count() const noexcept -> std::size_t;
 
     auto index_code_mut(std::size_t index) -> InstructionIterator;
 
-    auto find_ident(std::string_view name) const noexcept -> IdentifierCacheEntry;
-    auto is_entry_found(IdentifierCacheEntry entry) const noexcept -> bool;
+    /**
+     * @brief Looks for a constant already holding the identifier
+     *
+     * @return The index in the list of constants, if there is one
+     */
+    auto find_ident(std::string_view name) const noexcept -> std::optional<std::size_t>;
 
     /**
      * @brief Adds the identifier to the cache
      *
      * @return The index in the list of constants
      */
-    auto add_ident(std::string_view name) noexcept -> std::size_t;
+    auto add_ident(std::string_view name) -> std::size_t;
+
+    /**
+     * @brief Finds or creates the interned string with the given characters. Interned strings live as long as the chunk
+     *
+     * @return A string value, equal interned strings share the same object
+     */
+    auto intern(std::string_view str) -> Value;
 
-    void set_global(Value::StringType&& name, Value value) noexcept;
+    void set_global(Value::StringType&& name, Value value);
 
-    auto find_global(Value::StringType name) noexcept -> GlobalMap::iterator;
+    auto find_global(std::string_view name) noexcept -> GlobalMap::iterator;
 
     auto is_global_found(GlobalMap::iterator it) const noexcept -> bool;
 
+    /**
+     * @brief Records that code assigning to the global has been compiled into the chunk
+     */
+    void mark_global_assigned(std::string_view name) noexcept;
+
+    /**
+     * @brief Check if any compiled code assigns to the global
+     *
+     * @return True if an assignment to the global has been compiled or every global is assumed assigned, false otherwise
+     */
+    auto is_global_assigned(std::string_view name) const noexcept -> bool;
+
+    /**
+     * @brief Treats every global as assigned from here on, for code compiled on its own to be linked after code it cannot
+     * see, which may assign any of them
+     */
+    void assume_globals_assigned() noexcept;
+
+    /**
+     * @brief Records that the global is defined by top level code compiled into the chunk
+     */
+    void mark_global_defined(std::string_view name) noexcept;
+
+    /**
+     * @brief Check if the global is guaranteed to exist once the code compiled so far has run
+     *
+     * @return True if the global is already set or defined by top level code, false otherwise
+     */
+    auto is_global_defined(std::string_view name) const noexcept -> bool;
+
     auto begin() noexcept -> InstructionIterator;
 
     auto end() noexcept -> InstructionIterator;
@@ -493,29 +958,108 @@ namespace ss
 
     void print_constants(VMConfig& cfg) const noexcept;
 
+    /**
+     * @brief Calls the function with every constant and global, the values that stay alive between runs
+     */
+    void visit_roots(const std::function<void(const Value&)>& f) const;
+
+    /**
+     * @brief Calls the function with every value on the stack
+     */
+    void visit_stack(const std::function<void(const Value&)>& f) const;
+
+    /**
+     * @brief Releases the spare capacity of the code and constants, to be called once compilation is done
+     */
+    void shrink_to_fit();
+
+    auto has_debug_info() const noexcept -> bool;
+
+    /**
+     * @brief Takes the debug info out of the chunk, leaving it without one
+     *
+     * @return The debug info, null if the chunk had none
+     */
+    auto detach_debug_info() noexcept -> std::unique_ptr<DebugInfo>;
+
+    /**
+     * @brief Gives the chunk back debug info detached from it, replacing any made since. Only valid while the code it
+     * describes is unchanged
+     */
+    void attach_debug_info(std::unique_ptr<DebugInfo> info) noexcept;
+
+    /**
+     * @brief Appends a chunk compiled on its own, as if its source had been compiled onto the end of this one. Constant
+     * indices, function entry points and return addresses are relocated, and strings are interned into this chunk. The
+     * module is left empty
+     */
+    void link(BytecodeChunk&& module);
+
+    /**
+     * @brief Copies out the script compiled since the chunk was last prepared. Must be taken before the script runs
+     */
+    auto save_program() const -> Program;
+
+    /**
+     * @brief Puts the program into the prepared chunk as if its script had just been compiled
+     */
+    void load_program(const Program& program);
+
+    /**
+     * @brief Check if the program is still what compiling its script into the chunk would produce
+     */
+    auto is_program_current(const Program& program) const noexcept -> bool;
+
    private:
     Instructions code;
-    std::vector<Value> constants;
-    std::vector<Value> stack;
-    std::vector<std::size_t> lines;
-    std::size_t last_line            = 0;
-    std::size_t instructions_on_line = 0;
+    ConstantList constants;
+    ValueStack stack;
     GlobalMap globals;
-    IdentifierCache identifier_cache;
-
-    void add_line(std::size_t line) noexcept;
+    InternTable interned_strings;
+    GlobalNameSet assigned_globals;
+    GlobalNameSet defined_globals;
+    bool all_globals_assigned;
+    std::unique_ptr<DebugInfo> debug;
+
+    auto debug_info() -> DebugInfo&;
+    void add_line(std::size_t line, std::size_t column, std::size_t file);
+    auto run_at(std::size_t offset) const noexcept -> const DebugInfo::LineRun*;
   };
 
   class Scanner
   {
    public:
-    Scanner(std::string&& src) noexcept;
+    /**
+     * @param memory Where the token list is allocated from
+     * @param line The line the source starts on, for sources cut out of a larger file
+     * @param column The column the source starts on
+     */
+    Scanner(
+     std::string&& src,
+     std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+     std::size_t line                  = 1,
+     std::size_t column                = 1) noexcept;
     ~Scanner() = default;
 
-    auto scan() -> std::vector<Token>;
+    /**
+     * @brief Scans the whole source
+     *
+     * @return Every token, the last one being END_OF_FILE
+     */
+    auto scan() -> TokenList;
+
+    /**
+     * @brief Scans a single token
+     *
+     * @return The next token, END_OF_FILE from then on once the source is exhausted
+     */
+    auto next() -> Token;
+
+    auto resource() const noexcept -> std::pmr::memory_resource*;
 
    private:
     std::string&& source;
+    std::pmr::memory_resource* memory;
     std::string::iterator starting_char;
     std::string::iterator current_char;
     std::size_t line;
@@ -531,29 +1075,110 @@ namespace ss
     auto make_string() -> Token;
     auto make_number() -> Token;
     auto make_identifier() -> Token;
-    auto identifier() -> Token::Type;
-    auto check_keyword(std::size_t start, std::size_t len, const char* rest, Token::Type type) const noexcept -> Token::Type;
+    auto identifier() const noexcept -> Token::Type;
     auto is_at_end() const noexcept -> bool;
+    auto source_end() const noexcept -> const char*;
     auto peek() const noexcept -> char;
     auto peek_next() const noexcept -> char;
     auto advance() noexcept -> char;
     auto advance_if_match(char expected) noexcept -> bool;
     void skip_whitespace() noexcept;
     auto is_digit(char c) const noexcept -> bool;
+    auto is_hex_digit(char c) const noexcept -> bool;
+    auto is_binary_digit(char c) const noexcept -> bool;
     auto is_alpha(char c) const noexcept -> bool;
   };
 
+  /**
+   * @brief The tokens the parser reads from. Either a list scanned up front, or tokens pulled from a scanner as they are
+   * needed, in which case only the previous token and those peeked ahead are kept, in a ring buffer that grows to fit the
+   * furthest lookahead
+   */
+  class TokenStream
+  {
+   public:
+    /**
+     * @param scanner Must outlive the stream, the buffer is allocated from its memory resource
+     */
+    explicit TokenStream(Scanner& scanner);
+    explicit TokenStream(TokenList&& tokens) noexcept;
+
+    /**
+     * @brief Looks at a token without consuming it, 0 being the current one. The reference is valid until the next call
+     * to peek or advance
+     */
+    auto peek(std::size_t n = 0) -> const Token&;
+
+    /**
+     * @brief The last token consumed. Undefined before the first advance
+     */
+    auto previous() const noexcept -> const Token&;
+
+    void advance();
+
+    auto resource() const noexcept -> std::pmr::memory_resource*;
+
+   private:
+    /**
+     * @brief Must be a power of two
+     */
+    static constexpr std::size_t INITIAL_CAPACITY = 16;
+
+    Scanner* scanner;
+    TokenList buffer;
+    /**
+     * @brief Index of the current token counting from the start of the source
+     */
+    std::size_t position;
+    /**
+     * @brief Index one past the last token scanned
+     */
+    std::size_t end;
+
+    void grow(std::size_t first);
+  };
+
+  /**
+   * @brief The type of a value as far as the compiler can prove it. UNKNOWN means it is only known at run time
+   */
+  enum class StaticType
+  {
+    UNKNOWN,
+    NIL,
+    BOOL,
+    NUMBER,
+    INT,
+    STRING,
+  };
+
+  constexpr auto to_string(StaticType type) noexcept -> const char*
+  {
+    switch (type) {
+      SS_ENUM_TO_STR_CASE(StaticType, UNKNOWN)
+      SS_ENUM_TO_STR_CASE(StaticType, NIL)
+      SS_ENUM_TO_STR_CASE(StaticType, BOOL)
+      SS_ENUM_TO_STR_CASE(StaticType, NUMBER)
+      SS_ENUM_TO_STR_CASE(StaticType, INT)
+      SS_ENUM_TO_STR_CASE(StaticType, STRING)
+      default: {
+        return "UNKNOWN";
+      }
+    }
+  }
+
   struct Local
   {
     Token name;
     std::size_t depth;
     bool initialized;
+    StaticType type = StaticType::UNKNOWN;
   };
 
+  class ModuleLoader;
+
   class Parser
   {
-    using TokenList     = std::vector<Token>;
-    using TokenIterator = TokenList::iterator;
+    using TypeList = std::pmr::vector<StaticType>;
 
     enum class Precedence
     {
@@ -563,9 +1188,13 @@ namespace ss
       AND,         // and
       EQUALITY,    // == !=
       COMPARISON,  // < > <= >=
+      BIT_OR,      // |
+      BIT_XOR,     // ^
+      BIT_AND,     // &
+      SHIFT,       // << >>
       TERM,        // + -
       FACTOR,      // / *
-      UNARY,       // - !
+      UNARY,       // - ! ~
       CALL,        // . ()
       PRIMARY,
     };
@@ -579,6 +1208,10 @@ namespace ss
         SS_ENUM_TO_STR_CASE(Precedence, AND)
         SS_ENUM_TO_STR_CASE(Precedence, EQUALITY)
         SS_ENUM_TO_STR_CASE(Precedence, COMPARISON)
+        SS_ENUM_TO_STR_CASE(Precedence, BIT_OR)
+        SS_ENUM_TO_STR_CASE(Precedence, BIT_XOR)
+        SS_ENUM_TO_STR_CASE(Precedence, BIT_AND)
+        SS_ENUM_TO_STR_CASE(Precedence, SHIFT)
         SS_ENUM_TO_STR_CASE(Precedence, TERM)
         SS_ENUM_TO_STR_CASE(Precedence, FACTOR)
         SS_ENUM_TO_STR_CASE(Precedence, UNARY)
@@ -589,7 +1222,7 @@ namespace ss
         }
       };
     }
-    using ParseFn = std::function<void(Parser*, bool)>;
+    using ParseFn = void (Parser::*)(bool);
 
     struct ParseRule
     {
@@ -598,6 +1231,8 @@ namespace ss
       Precedence precedence;
     };
 
+    using RuleTable = std::array<ParseRule, static_cast<std::size_t>(Token::Type::LAST)>;
+
     struct VarLookup
     {
       enum class Type
@@ -615,18 +1250,84 @@ namespace ss
       FUNCTION,
     };
 
+    /**
+     * @brief An emitted arithmetic or comparison instruction
+     */
+    struct OpSite
+    {
+      std::size_t offset;
+      OpCode generic;
+      bool typed;
+      Token op;
+    };
+
+    /**
+     * @brief Type assumptions made while compiling a loop. The types of the locals at the start of the loop are assumed
+     * to hold for every iteration, if an assignment in the loop breaks that the typed instructions are made generic again
+     */
+    struct TypeFrame
+    {
+      std::size_t first_site;
+      TypeList entry_types;
+      std::pmr::vector<std::size_t> assigned;
+      bool violated;
+    };
+
    public:
-    Parser(TokenList&& tokens, BytecodeChunk& chunk, std::string current_file) noexcept;
+    /**
+     * @brief The working storage of the parser is allocated from the same memory resource as the tokens
+     */
+    Parser(TokenList&& tokens, BytecodeChunk& chunk, std::string current_file, bool lazy_functions = false);
+
+    /**
+     * @brief Pulls tokens from the scanner as parsing goes, the scanner must outlive the parser
+     *
+     * @param lazy_functions Whether function bodies are only checked for matching braces and compiled on their first call
+     */
+    Parser(Scanner& scanner, BytecodeChunk& chunk, std::string current_file, bool lazy_functions = false);
     ~Parser() = default;
 
     void parse();
 
+    /**
+     * @brief Parses a loaded file, unlike a script it does not end execution when it is done
+     */
+    void parse_module();
+
+    /**
+     * @brief Where load statements take files compiled ahead of time from, files it has none for are compiled in place
+     */
+    void set_modules(ModuleLoader* loader) noexcept;
+
+    /**
+     * @brief Where the files loaded along the way are recorded, along with the time spent on them
+     */
+    void set_stats(CompileStats* stats) noexcept;
+
+    /**
+     * @brief Compiles the body of a lazily compiled function, the tokens being its source. Appends the code to the chunk
+     * and points the function at it
+     */
+    void parse_function(Function& fn);
+
    private:
-    TokenList tokens;
-    TokenIterator iter;
+    TokenStream tokens;
     BytecodeChunk& chunk;
     std::string current_file;
-    std::vector<Local> locals;
+    /**
+     * @brief Index of the current file in the chunk, what emitted instructions are tagged with
+     */
+    std::size_t file_index;
+    bool lazy_functions;
+    ModuleLoader* modules;
+    CompileStats* stats;
+    std::pmr::memory_resource* memory;
+    /**
+     * @brief Where the local types saved at branches and loops are kept. They only live until the join, the pool reuses
+     * their memory where the arena would hold on to it until the compile is done
+     */
+    std::pmr::unsynchronized_pool_resource type_memory;
+    std::pmr::vector<Local> locals;
 
     /**
      * @brief Current scope depth. 0 is the global namespace, depth > 0 creates local variables
@@ -651,7 +1352,7 @@ namespace ss
     /**
      * @brief Jump instructions to patch after loop end
      */
-    std::vector<std::size_t> breaks;
+    std::pmr::vector<std::size_t> breaks;
 
     /**
      * @brief True if inside some kind of function, false otherwise
@@ -668,20 +1369,40 @@ namespace ss
      */
     std::size_t function_depth;
 
+    /**
+     * @brief Static type of the last compiled expression
+     */
+    StaticType expr_type;
+
+    /**
+     * @brief Every arithmetic and comparison instruction emitted so far
+     */
+    std::pmr::vector<OpSite> op_sites;
+
+    /**
+     * @brief Type assumptions of the loops currently being compiled
+     */
+    std::pmr::vector<TypeFrame> type_frames;
+
     template <typename... Args>
-    void error(TokenIterator tok, Args&&... args) const
+    void error(const Token& tok, Args&&... args) const
     {
-      CompiletimeError::throw_err(tok->line, ":", tok->column, " -> ", args...);
+      CompiletimeError::throw_err(tok.line, ":", tok.column, " -> ", args...);
     }
 
     void write_instruction(Instruction i);
-    auto previous() const -> TokenIterator;
-    void advance() noexcept;
-    void consume(Token::Type type, std::string err);
+    auto previous() const -> const Token&;
+    auto current() -> const Token&;
+    void advance();
+    void consume(Token::Type type, std::string_view err);
     void emit_instruction(Instruction i);
     void emit_constant(Value v);
     auto emit_jump(Instruction i) -> std::size_t;
     void patch_jump(std::size_t jump_loc);
+    /**
+     * @brief Emits the typed instruction if the operand types are proven, the generic one otherwise
+     */
+    void emit_op(const Token& op, OpCode generic, OpCode typed, bool proven);
     /**
      * @brief Prepares for a new scope. Used for functions or control flow
      */
@@ -709,15 +1430,45 @@ namespace ss
      * @param f The function or lambda to call
      */
     void wrap_loop(std::size_t cont_jmp, auto f);
+    /**
+     * @brief Hoists loop invariant global lookups into hidden locals, then calls the function to compile the loop.
+     *
+     * A global is invariant when it is defined before the loop and nothing that can run during the loop assigns it. Only
+     * top level loops are considered, as a loop inside a function can be entered after more code has been compiled
+     *
+     * @param f The function or lambda to call
+     */
+    void wrap_invariants(auto f);
+    /**
+     * @brief Calls a function after assuming the current local types hold for every iteration of a loop. If the assumption
+     * is broken, the typed instructions emitted by the function are reverted
+     *
+     * @param f The function or lambda to call
+     */
+    void wrap_loop_types(auto f);
 
+    /**
+     * @brief Builds the rule table, failing to compile unless every token type is given exactly one rule
+     */
+    static consteval auto make_rules() -> RuleTable;
     auto rule_for(Token::Type t) const noexcept -> const ParseRule&;
     void parse_precedence(Precedence p);
     void make_number(bool can_assign);
     void make_string(bool can_assign);
     void make_variable(bool assign);
     void make_function(std::string name);
-    void named_variable(TokenIterator name, bool assign);
-    auto parse_variable(std::string err_msg) -> std::size_t;
+    /**
+     * @brief Emits a function whose body is compiled on its first call, skipping over the body
+     */
+    void defer_function(std::string name);
+    /**
+     * @brief Compiles the parameter list and body of a function into the current position of the chunk
+     *
+     * @return The number of parameters
+     */
+    auto function_body() -> std::size_t;
+    void named_variable(Token name, bool assign);
+    auto parse_variable(std::string_view err_msg) -> std::size_t;
     auto parse_arg_list() -> std::size_t;
     /**
      * @brief Defines a new variable.
@@ -726,12 +1477,27 @@ namespace ss
      */
     void define_variable(std::size_t global);
     void declare_variable();
-    auto identifier_constant(TokenIterator name) -> std::size_t;
+    auto identifier_constant(const Token& name) -> std::size_t;
     auto check(Token::Type type) -> bool;
     auto advance_if_matches(Token::Type type) -> bool;
-    void add_local(TokenIterator token) noexcept;
-    auto resolve_local(TokenIterator token) const -> VarLookup;
+    void add_local(const Token& token) noexcept;
+    auto resolve_local(const Token& token) const -> VarLookup;
+    auto is_local(const Token& token) const noexcept -> bool;
+    /**
+     * @brief Peeks ahead to the end of the loop starting at the current token
+     *
+     * @return The number of tokens the loop spans
+     */
+    auto find_loop_end() -> std::size_t;
     auto reduce_locals_to_depth(std::size_t depth) -> std::size_t;
+    void assign_local_type(std::size_t index, StaticType type);
+    auto snapshot_types() -> TypeList;
+    void restore_types(const TypeList& types);
+    /**
+     * @brief Merges the local types at a control flow join with the types of the other incoming path
+     */
+    void join_types(const TypeList& types);
+    void report_generic_ops() const;
 
     void expression();
     void grouping_expr(bool);
@@ -761,14 +1527,199 @@ namespace ss
     void match_stmt();
     void load_stmt();
     void loadr_stmt();
+    /**
+     * @brief Links in the file if it was compiled ahead of time, otherwise compiles it into the chunk here
+     */
+    void load_module(const std::string& path);
     void fn_stmt();
   };
 
+  /**
+   * @brief Rewrites stack instruction sequences into register instructions for the register backend.
+   *
+   * The first instruction of a sequence is replaced and the rest are left in place to be skipped at run time, that way
+   * jump offsets, function entry points and return addresses all stay valid. Sequences never span a jump target
+   */
+  class RegisterTranslator
+  {
+   public:
+    RegisterTranslator(BytecodeChunk& chunk) noexcept;
+    ~RegisterTranslator() = default;
+
+    /**
+     * @brief Translates every instruction from the offset to the end of the chunk
+     */
+    void translate(std::size_t offset);
+
+    /**
+     * @brief Number of instructions a register instruction stands in for
+     *
+     * @return The number of instructions to advance past after executing it
+     */
+    static constexpr auto length_of(Instruction i) noexcept -> std::size_t
+    {
+      if (i.major_opcode == OpCode::BINARY_R) {
+        return RegisterOperands::unpack(i.modifying_bits).dest == RegisterOperands::PUSH ? 3 : 5;
+      }
+      return 3;
+    }
+
+   private:
+    BytecodeChunk& chunk;
+    std::vector<bool> targets;
+
+    void find_targets(std::size_t offset);
+    auto is_target(std::size_t index) const noexcept -> bool;
+    auto source_of(Instruction i, RegisterOperands::Source& src) const noexcept -> bool;
+    static auto is_binary(OpCode op) noexcept -> bool;
+  };
+
   class Compiler
   {
    public:
-    Compiler() = default;
-    void compile(std::string&& src, BytecodeChunk& chunk, std::string current_file);
+    /**
+     * @param lazy_functions Whether function bodies are compiled on their first call instead of up front, syntax errors
+     * within them surface then as well
+     */
+    explicit Compiler(bool lazy_functions = false, std::size_t module_threads = 0) noexcept;
+    /**
+     * @brief Compiles the source into the chunk. Tokens and parser state live in an arena that is released in one go
+     * when this returns
+     *
+     * @param stats Where the time spent is recorded, if anywhere. The source is scanned to a token list up front then, so
+     * scanning and parsing can be timed apart
+     */
+    void compile(std::string&& src, BytecodeChunk& chunk, std::string current_file, CompileStats* stats = nullptr);
+
+    /**
+     * @brief Compiles a loaded file into the chunk, execution carries on past its end
+     *
+     * @param modules Where the loads of the file are taken from, if anywhere
+     */
+    void compile_module(
+     std::string&& src,
+     BytecodeChunk& chunk,
+     std::string current_file,
+     ModuleLoader* modules = nullptr,
+     CompileStats* stats   = nullptr);
+
+    /**
+     * @brief Compiles the body of a lazily compiled function onto the end of the chunk
+     */
+    void compile_function(Function& fn, BytecodeChunk& chunk);
+
+   private:
+    bool lazy_functions;
+    /**
+     * @brief Threads loaded files are compiled on ahead of the script, 0 compiles them in place as they are loaded
+     */
+    std::size_t module_threads;
+
+    void run(
+     std::string&& src,
+     BytecodeChunk& chunk,
+     std::string current_file,
+     ModuleLoader* modules,
+     CompileStats* stats,
+     bool module);
+  };
+
+  /**
+   * @brief Compiles the files a script loads concurrently, ahead of the script itself.
+   *
+   * The script and everything it loads are first scanned for load statements, then every file is compiled into a chunk of
+   * its own on a pool of threads. Load statements link the finished chunks in as they are reached, so the result matches
+   * compiling each file in place. A load reached before its file was picked up by the pool compiles it on the spot. Files
+   * are compiled once per load statement naming them, as they are when compiled in place
+   */
+  class ModuleLoader
+  {
+   public:
+    /**
+     * @param threads Size of the pool, at least one is used
+     * @param collect_stats Whether the compilations record their stats, handed over along with the chunks
+     */
+    ModuleLoader(bool lazy_functions, std::size_t threads, bool collect_stats = false);
+    ~ModuleLoader();
+
+    ModuleLoader(const ModuleLoader&) = delete;
+    ModuleLoader(ModuleLoader&&)      = delete;
+
+    auto operator=(const ModuleLoader&) -> ModuleLoader& = delete;
+    auto operator=(ModuleLoader&&) -> ModuleLoader&      = delete;
+
+    /**
+     * @brief Finds every file the script loads, directly or not, and starts compiling them. Must be called once, before
+     * anything is taken. The source is only read
+     */
+    void prefetch(std::string& src, const std::string& current_file);
+
+    /**
+     * @brief Hands over a compiled file, waiting for it if it is still being compiled
+     *
+     * @param stats Where the stats of the compilation are moved to, if anywhere
+     * @return Null if the file was not prefetched or every compilation of it was already taken
+     * @throws CompiletimeError When compiling the file failed
+     */
+    auto take(const std::string& path, CompileStats* stats = nullptr) -> std::unique_ptr<BytecodeChunk>;
+
+    /**
+     * @brief The files a load statement names, one per library directory in SS_LIB (~/.simple by default) that has it
+     */
+    static auto library_paths(std::string_view file) -> std::vector<std::string>;
+
+    /**
+     * @brief The file a loadr statement names, relative to the file the statement is in
+     */
+    static auto relative_path(std::string_view current_file, std::string_view file) -> std::string;
+
+   private:
+    enum class State
+    {
+      PENDING,
+      RUNNING,
+      DONE,
+    };
+
+    struct Job
+    {
+      std::string path;
+      std::string source;
+      State state = State::PENDING;
+      std::unique_ptr<BytecodeChunk> chunk;
+      CompileStats stats;
+      std::exception_ptr error;
+    };
+
+    bool lazy_functions;
+    std::size_t thread_count;
+    bool collect_stats;
+    std::vector<std::unique_ptr<Job>> jobs;
+    /**
+     * @brief Jobs not taken yet, oldest first for every path
+     */
+    std::unordered_map<std::string, std::deque<Job*>> untaken;
+    /**
+     * @brief Every global assigned anywhere in the files, marked in each chunk up front. A file cannot know which globals
+     * the code linked around it assigns, so invariant hoisting has to assume all of them
+     */
+    BytecodeChunk::GlobalNameSet assigned;
+    std::atomic<std::size_t> next_job;
+    std::mutex lock;
+    std::condition_variable finished;
+    std::vector<std::thread> workers;
+
+    /**
+     * @brief Queues a job for every file the source loads, then scans those files in turn
+     *
+     * @param ancestors The files loading this one, a file loading itself is left to fail when compiled in place
+     */
+    void scan_loads(std::string& src, const std::string& current_file, std::vector<std::string>& ancestors);
+    void work();
+    /**
+     * @brief Compiles the file of the job unless another thread already started on it
+     */
+    void run(Job& job);
   };
 
 }  // namespace ss
\ No newline at end of file
@@ -1,13 +1,114 @@
 #include "datatypes.hpp"
 
 #include "exceptions.hpp"
+#include "gc.hpp"
+#include "util.hpp"
 
 #include <cmath>
+#include <compare>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 
 namespace ss
 {
+  namespace
+  {
+    auto is_mixed_numeric(const Value& a, const Value& b) noexcept -> bool
+    {
+      return (a.is_type(Value::Type::Int) && b.is_type(Value::Type::Number))
+          || (a.is_type(Value::Type::Number) && b.is_type(Value::Type::Int));
+    }
+
+    /**
+     * @brief Compares an integer with a number exactly, converting either to the other's type could round
+     */
+    auto compare_exact(Value::IntType i, Value::NumberType d) noexcept -> std::partial_ordering
+    {
+      // 2^63, the first double past the largest integer
+      constexpr Value::NumberType LIMIT = 9223372036854775808.0;
+
+      if (std::isnan(d)) {
+        return std::partial_ordering::unordered;
+      } else if (d >= LIMIT) {
+        return std::partial_ordering::less;
+      } else if (d < -LIMIT) {
+        return std::partial_ordering::greater;
+      }
+
+      // in range the truncation is exact, and so is the fraction left over
+      auto whole = static_cast<Value::IntType>(d);
+      if (i != whole) {
+        return i <=> whole;
+      }
+      return 0.0 <=> d - static_cast<Value::NumberType>(whole);
+    }
+
+    auto compare_mixed(const Value& a, const Value& b) noexcept -> std::partial_ordering
+    {
+      if (a.is_type(Value::Type::Int)) {
+        return compare_exact(a.integer_unchecked(), b.number_unchecked());
+      }
+      return 0 <=> compare_exact(b.integer_unchecked(), a.number_unchecked());
+    }
+
+    /**
+     * @brief Upper bound of the characters append_text adds for the value
+     */
+    auto text_size(const Value& v) noexcept -> std::size_t
+    {
+      switch (v.type()) {
+        case Value::Type::String: {
+          return v.string_view().size();
+        }
+        case Value::Type::Bool: {
+          return 5;
+        }
+        default: {
+          return std::tuple_size_v<util::NumberBuffer>;
+        }
+      }
+    }
+
+    /**
+     * @brief Appends the text of a value that can be added to a string
+     *
+     * @return False if the value can not be added to a string
+     */
+    auto append_text(Value::StringType& out, const Value& v) -> bool
+    {
+      util::NumberBuffer buffer;
+      switch (v.type()) {
+        case Value::Type::String: {
+          out.append(v.string_view());
+        } break;
+        case Value::Type::Bool: {
+          out.append(v.boolean() ? "true" : "false");
+        } break;
+        case Value::Type::Number: {
+          out.append(util::format_number(v.number_unchecked(), buffer));
+        } break;
+        case Value::Type::Int: {
+          out.append(util::format_number(v.integer_unchecked(), buffer));
+        } break;
+        default: {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    auto repeat(std::string_view str, double times) -> Value
+    {
+      Value::StringType result;
+      if (times > 0) {
+        result.reserve(str.size() * static_cast<std::size_t>(std::ceil(times)));
+      }
+      for (double i = 0; i < times; i++) { result.append(str); }
+      return Value(std::move(result));
+    }
+  }  // namespace
+
   Value::NilType Value::nil;
 
   Value::Value()
@@ -22,7 +123,15 @@ namespace ss
    : value(v)
   {}
 
+  Value::Value(IntType v)
+   : value(v)
+  {}
+
   Value::Value(StringType v)
+   : value(std::make_shared<String>(std::move(v)))
+  {}
+
+  Value::Value(StringObjectType v)
    : value(v)
   {}
 
@@ -55,20 +164,59 @@ namespace ss
   {
     if (this->is_type(Type::Number)) {
       return std::get<NumberType>(this->value);
+    } else if (this->is_type(Type::Int)) {
+      return static_cast<NumberType>(std::get<IntType>(this->value));
     } else {
       return NumberType();
     }
   }
 
+  auto Value::number_unchecked() const noexcept -> NumberType
+  {
+    return *std::get_if<NumberType>(&this->value);
+  }
+
+  auto Value::integer() const -> IntType
+  {
+    if (this->is_type(Type::Int)) {
+      return std::get<IntType>(this->value);
+    } else {
+      return IntType();
+    }
+  }
+
+  auto Value::integer_unchecked() const noexcept -> IntType
+  {
+    return *std::get_if<IntType>(&this->value);
+  }
+
   auto Value::string() const -> StringType
   {
     if (this->is_type(Type::String)) {
-      return std::get<StringType>(this->value);
+      return StringType(std::get<StringObjectType>(this->value)->view());
     } else {
       return StringType();
     }
   }
 
+  auto Value::string_view() const noexcept -> std::string_view
+  {
+    if (this->is_type(Type::String)) {
+      return std::get<StringObjectType>(this->value)->view();
+    } else {
+      return std::string_view();
+    }
+  }
+
+  auto Value::string_object() const -> StringObjectType
+  {
+    if (this->is_type(Type::String)) {
+      return std::get<StringObjectType>(this->value);
+    } else {
+      return nullptr;
+    }
+  }
+
   auto Value::function() const -> FunctionType
   {
     if (this->is_type(Type::Function)) {
@@ -87,6 +235,17 @@ namespace ss
     }
   }
 
+  auto Value::object() const noexcept -> Object*
+  {
+    if (auto fn = std::get_if<FunctionType>(&this->value); fn != nullptr) {
+      return fn->get();
+    } else if (auto native = std::get_if<NativeFunctionType>(&this->value); native != nullptr) {
+      return native->get();
+    } else {
+      return nullptr;
+    }
+  }
+
   auto Value::address() const -> AddressType
   {
     if (this->is_type(Type::Address)) {
@@ -126,12 +285,15 @@ namespace ss
         }
       }
       case Type::Number: {
-        std::stringstream ss;
-        ss << std::get<NumberType>(this->value);
-        return ss.str();
+        util::NumberBuffer buffer;
+        return std::string(util::format_number(std::get<NumberType>(this->value), buffer));
+      }
+      case Type::Int: {
+        util::NumberBuffer buffer;
+        return std::string(util::format_number(std::get<IntType>(this->value), buffer));
       }
       case Type::String: {
-        return std::get<StringType>(this->value);
+        return std::string(std::get<StringObjectType>(this->value)->view());
       }
       case Type::Function: {
         return std::get<FunctionType>(this->value)->to_string();
@@ -157,6 +319,9 @@ namespace ss
       case Type::Number: {
         return Value(-std::get<NumberType>(this->value));
       }
+      case Type::Int: {
+        return Value(wrapping_neg(std::get<IntType>(this->value)));
+      }
       default:
         break;
     }
@@ -169,120 +334,79 @@ namespace ss
     return Value(!this->truthy());
   }
 
+  auto Value::operator~() const -> Value
+  {
+    if (this->is_type(Type::Int)) {
+      return Value(~std::get<IntType>(this->value));
+    }
+    RuntimeError::throw_err("bitwise not on invalid type");
+    return Value();
+  }
+
   auto Value::operator+(const Value& other) const -> Value
   {
-    switch (this->type()) {
-      case Type::Number: {
-        auto a = std::get<NumberType>(this->value);
-        switch (other.type()) {
-          case Type::Number: {
-            auto b = std::get<NumberType>(other.value);
-            return Value(a + b);
-          }
-          case Type::String: {
-            auto b = std::get<StringType>(other.value);
-            std::stringstream ss;
-            ss << a << b;
-            return Value(ss.str());
-          }
-          default:
-            break;
-        }
-      } break;
-      case Type::String: {
-        auto a = std::get<StringType>(this->value);
-        switch (other.type()) {
-          case Type::Number: {
-            auto b = std::get<NumberType>(other.value);
-            std::stringstream ss;
-            ss << a << b;
-            return Value(ss.str());
-          }
-          case Type::String: {
-            auto b = std::get<StringType>(other.value);
-            std::stringstream ss;
-            ss << a << b;
-            return Value(ss.str());
-          }
-          case Type::Bool: {
-            auto b = std::get<BoolType>(other.value);
-            std::stringstream ss;
-            ss << a << (b ? "true" : "false");
-            return Value(ss.str());
-          }
-          default:
-            break;
-        }
-      } break;
-      case Type::Bool: {
-        auto a = std::get<BoolType>(this->value);
-        switch (other.type()) {
-          case Type::String: {
-            auto b = std::get<StringType>(other.value);
-            std::stringstream ss;
-            ss << (a ? "true" : "false") << b;
-            return Value(ss.str());
-          }
-          default:
-            break;
-        }
-      } break;
-      default:
-        break;
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      return Value(wrapping_add(std::get<IntType>(this->value), std::get<IntType>(other.value)));
+    }
+
+    if (this->is_numeric() && other.is_numeric()) {
+      return Value(this->number() + other.number());
     }
+
+    if (this->is_type(Type::String) || other.is_type(Type::String)) {
+      StringType result;
+      result.reserve(text_size(*this) + text_size(other));
+      if (append_text(result, *this) && append_text(result, other)) {
+        return Value(std::move(result));
+      }
+    }
+
     RuntimeError::throw_err("unable to add invalid types");
     return Value();
   }
 
   auto Value::operator-(const Value& other) const -> Value
   {
-    switch (this->type()) {
-      case Type::Number: {
-        auto a = std::get<NumberType>(this->value);
-        switch (other.type()) {
-          case Type::Number: {
-            auto b = std::get<NumberType>(other.value);
-            return Value(a - b);
-          }
-          default:
-            break;
-        }
-      }
-      default:
-        break;
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      return Value(wrapping_sub(std::get<IntType>(this->value), std::get<IntType>(other.value)));
+    }
+
+    if (this->is_numeric() && other.is_numeric()) {
+      return Value(this->number() - other.number());
     }
+
     RuntimeError::throw_err("unable to sub invalid types");
     return Value();
   }
 
   auto Value::operator*(const Value& other) const -> Value
   {
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      return Value(wrapping_mul(std::get<IntType>(this->value), std::get<IntType>(other.value)));
+    }
+
+    if (this->is_numeric() && other.is_numeric()) {
+      return Value(this->number() * other.number());
+    }
+
     switch (this->type()) {
-      case Type::Number: {
-        auto a = std::get<NumberType>(this->value);
+      case Type::Number:
+      case Type::Int: {
+        auto a = this->number();
         switch (other.type()) {
-          case Type::Number: {
-            auto b = std::get<NumberType>(other.value);
-            return Value(a * b);
-          }
           case Type::String: {
-            auto b = std::get<StringType>(other.value);
-            std::stringstream ss;
-            for (double i = 0; i < a; i++) { ss << b; }
-            return Value(ss.str());
+            return repeat(std::get<StringObjectType>(other.value)->view(), a);
           }
           default:
             break;
         }
       } break;
       case Type::String: {
-        auto a = std::get<StringType>(this->value);
+        auto a = std::get<StringObjectType>(this->value)->view();
         switch (other.type()) {
-          case Type::Number: {
-            auto b = std::get<NumberType>(other.value);
-            std::stringstream ss;
-            for (double i = 0; i < b; i++) { ss << a; }
-            return Value(ss.str());
+          case Type::Number:
+          case Type::Int: {
+            return repeat(a, other.number());
           }
           default:
             break;
@@ -297,46 +421,137 @@ namespace ss
 
   auto Value::operator/(const Value& other) const -> Value
   {
-    switch (this->type()) {
-      case Type::Number: {
-        auto a = std::get<NumberType>(this->value);
-        switch (other.type()) {
-          case Type::Number: {
-            auto b = std::get<NumberType>(other.value);
-            return Value(a / b);
-          }
-          default:
-            break;
-        }
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      auto a = std::get<IntType>(this->value);
+      auto b = std::get<IntType>(other.value);
+      // integer division only when exact, everything else promotes to a number
+      if (b == -1) {
+        return Value(wrapping_neg(a));
+      } else if (b != 0 && a % b == 0) {
+        return Value(a / b);
       }
-      default:
-        break;
     }
+
+    if (this->is_numeric() && other.is_numeric()) {
+      return Value(this->number() / other.number());
+    }
+
     RuntimeError::throw_err("unable to div invalid types");
     return Value();
   }
 
   auto Value::operator%(const Value& other) const -> Value
   {
-    switch (this->type()) {
-      case Type::Number: {
-        auto a = std::get<NumberType>(this->value);
-        switch (other.type()) {
-          case Type::Number: {
-            auto b = std::get<NumberType>(other.value);
-            return Value(std::fmod(a, b));
-          }
-          default:
-            break;
-        }
-      }
-      default:
-        break;
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      return remainder(std::get<IntType>(this->value), std::get<IntType>(other.value));
+    }
+
+    if (this->is_numeric() && other.is_numeric()) {
+      return Value(std::fmod(this->number(), other.number()));
     }
+
     RuntimeError::throw_err("unable to mod invalid types");
     return Value();
   }
 
+  auto Value::operator&(const Value& other) const -> Value
+  {
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      return Value(std::get<IntType>(this->value) & std::get<IntType>(other.value));
+    }
+    RuntimeError::throw_err("unable to bitwise and invalid types");
+    return Value();
+  }
+
+  auto Value::operator|(const Value& other) const -> Value
+  {
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      return Value(std::get<IntType>(this->value) | std::get<IntType>(other.value));
+    }
+    RuntimeError::throw_err("unable to bitwise or invalid types");
+    return Value();
+  }
+
+  auto Value::operator^(const Value& other) const -> Value
+  {
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      return Value(std::get<IntType>(this->value) ^ std::get<IntType>(other.value));
+    }
+    RuntimeError::throw_err("unable to bitwise xor invalid types");
+    return Value();
+  }
+
+  auto Value::operator<<(const Value& other) const -> Value
+  {
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      auto a = std::get<IntType>(this->value);
+      auto n = std::get<IntType>(other.value);
+      if (n < 0) {
+        RuntimeError::throw_err("negative shift count");
+      } else if (n >= 64) {
+        return Value(IntType{0});
+      }
+      return Value(static_cast<IntType>(static_cast<std::uint64_t>(a) << n));
+    }
+    RuntimeError::throw_err("unable to shift invalid types");
+    return Value();
+  }
+
+  auto Value::operator>>(const Value& other) const -> Value
+  {
+    if (this->is_type(Type::Int) && other.is_type(Type::Int)) {
+      auto a = std::get<IntType>(this->value);
+      auto n = std::get<IntType>(other.value);
+      if (n < 0) {
+        RuntimeError::throw_err("negative shift count");
+      } else if (n >= 64) {
+        return Value(IntType{a < 0 ? -1 : 0});
+      }
+      // arithmetic shift, the sign is kept
+      return Value(a >> n);
+    }
+    RuntimeError::throw_err("unable to shift invalid types");
+    return Value();
+  }
+
+  auto Value::concat(std::span<const Value> values) -> Value
+  {
+    if (values.empty()) {
+      return Value();
+    }
+
+    if (values.size() < 2 || !(values[0].is_type(Type::String) || values[1].is_type(Type::String))) {
+      // not a string chain, fold it the way nested additions would
+      Value acc = values[0];
+      for (std::size_t i = 1; i < values.size(); i++) { acc = acc + values[i]; }
+      return acc;
+    }
+
+    std::size_t length = 0;
+    for (const auto& v : values) { length += text_size(v); }
+
+    StringType result;
+    result.reserve(length);
+    for (const auto& v : values) {
+      if (!append_text(result, v)) {
+        RuntimeError::throw_err("unable to add invalid types");
+      }
+    }
+
+    return Value(std::move(result));
+  }
+
+  auto Value::remainder(IntType a, IntType b) noexcept -> Value
+  {
+    if (b == 0) {
+      return Value(std::numeric_limits<NumberType>::quiet_NaN());
+    } else if (b == -1) {
+      // the smallest integer would overflow
+      return Value(IntType{0});
+    }
+    return Value(a % b);
+  }
+
   auto Value::operator=(NilType v) noexcept -> Value&
   {
     this->value = v;
@@ -355,13 +570,19 @@ namespace ss
     return *this;
   }
 
-  auto Value::operator=(StringType v) noexcept -> Value&
+  auto Value::operator=(IntType v) noexcept -> Value&
   {
     this->value = v;
     return *this;
   }
 
-  auto Value::operator=(const char* v) noexcept -> Value&
+  auto Value::operator=(StringType v) -> Value&
+  {
+    this->value = std::make_shared<String>(std::move(v));
+    return *this;
+  }
+
+  auto Value::operator=(const char* v) -> Value&
   {
     return *this = StringType(v);
   }
@@ -380,32 +601,68 @@ namespace ss
 
   auto Value::operator==(const Value& other) const noexcept -> bool
   {
+    if (this->is_type(Type::String) && other.is_type(Type::String)) {
+      return *std::get<StringObjectType>(this->value) == *std::get<StringObjectType>(other.value);
+    }
+    if (is_mixed_numeric(*this, other)) {
+      return compare_mixed(*this, other) == 0;
+    }
     return this->value == other.value;
   }
 
   auto Value::operator!=(const Value& other) const noexcept -> bool
   {
+    if (this->is_type(Type::String) && other.is_type(Type::String)) {
+      return *std::get<StringObjectType>(this->value) != *std::get<StringObjectType>(other.value);
+    }
+    if (is_mixed_numeric(*this, other)) {
+      return compare_mixed(*this, other) != 0;
+    }
     return this->value != other.value;
   }
 
   auto Value::operator>(const Value& other) const noexcept -> bool
   {
+    if (this->is_type(Type::String) && other.is_type(Type::String)) {
+      return *std::get<StringObjectType>(this->value) > *std::get<StringObjectType>(other.value);
+    }
+    if (is_mixed_numeric(*this, other)) {
+      return compare_mixed(*this, other) > 0;
+    }
     return this->value > other.value;
   }
 
   auto Value::operator>=(const Value& other) const noexcept -> bool
   {
+    if (this->is_type(Type::String) && other.is_type(Type::String)) {
+      return *std::get<StringObjectType>(this->value) >= *std::get<StringObjectType>(other.value);
+    }
+    if (is_mixed_numeric(*this, other)) {
+      return compare_mixed(*this, other) >= 0;
+    }
     return this->value >= other.value;
   }
 
   auto Value::operator<(const Value& other) const noexcept -> bool
   {
+    if (this->is_type(Type::String) && other.is_type(Type::String)) {
+      return *std::get<StringObjectType>(this->value) < *std::get<StringObjectType>(other.value);
+    }
+    if (is_mixed_numeric(*this, other)) {
+      return compare_mixed(*this, other) < 0;
+    }
     return this->value < other.value;
   }
 
   auto Value::operator<=(const Value& other) const noexcept -> bool
   {
-    return this->value < other.value;
+    if (this->is_type(Type::String) && other.is_type(Type::String)) {
+      return *std::get<StringObjectType>(this->value) <= *std::get<StringObjectType>(other.value);
+    }
+    if (is_mixed_numeric(*this, other)) {
+      return compare_mixed(*this, other) <= 0;
+    }
+    return this->value <= other.value;
   }
 
   auto Value::type() const noexcept -> Type
@@ -418,22 +675,163 @@ namespace ss
     return this->type() == t;
   }
 
+  auto Value::is_numeric() const noexcept -> bool
+  {
+    return this->is_type(Type::Number) || this->is_type(Type::Int);
+  }
+
   auto operator<<(std::ostream& ostream, const Value& value) -> std::ostream&
   {
-    return ostream << value.to_string();
+    util::NumberBuffer buffer;
+    switch (value.type()) {
+      case Value::Type::Number: {
+        return ostream << util::format_number(value.number_unchecked(), buffer);
+      }
+      case Value::Type::Int: {
+        return ostream << util::format_number(value.integer_unchecked(), buffer);
+      }
+      case Value::Type::String: {
+        return ostream << value.string_view();
+      }
+      default: {
+        return ostream << value.to_string();
+      }
+    }
+  }
+
+  String::String(std::string str, const void* p)
+   : data(std::move(str))
+   , parent(nullptr)
+   , chars(this->data)
+   , pool(p)
+   , memory(MemoryTracker::active())
+   , hash_code(0)
+   , hashed(false)
+  {
+    if (this->memory != nullptr) {
+      this->memory->allocate(MemoryTracker::Category::STRINGS, this->footprint());
+    }
+  }
+
+  String::String(std::shared_ptr<String> p, std::size_t offset, std::size_t length)
+   : data()
+   , parent(std::move(p))
+   , chars(this->parent->view().substr(offset, length))
+   , pool(nullptr)
+   , memory(MemoryTracker::active())
+   , hash_code(0)
+   , hashed(false)
+  {
+    if (this->memory != nullptr) {
+      this->memory->allocate(MemoryTracker::Category::STRINGS, this->footprint());
+    }
+  }
+
+  String::~String()
+  {
+    if (this->memory != nullptr) {
+      this->memory->deallocate(MemoryTracker::Category::STRINGS, this->footprint());
+    }
+  }
+
+  auto String::footprint() const noexcept -> std::size_t
+  {
+    return sizeof(String) + (this->is_slice() ? 0 : this->data.capacity());
+  }
+
+  auto String::slice(const std::shared_ptr<String>& str, std::size_t offset, std::size_t length) -> std::shared_ptr<String>
+  {
+    offset = std::min(offset, str->size());
+    length = std::min(length, str->size() - offset);
+
+    if (offset == 0 && length == str->size()) {
+      return str;
+    }
+
+    // slices of slices borrow from the owner directly, that way chains of them never keep each other alive
+    if (str->is_slice()) {
+      auto owner = str->parent;
+      return std::make_shared<String>(owner, offset + (str->chars.data() - owner->chars.data()), length);
+    }
+
+    return std::make_shared<String>(str, offset, length);
+  }
+
+  auto String::view() const noexcept -> std::string_view
+  {
+    return this->chars;
+  }
+
+  auto String::size() const noexcept -> std::size_t
+  {
+    return this->chars.size();
+  }
+
+  auto String::is_slice() const noexcept -> bool
+  {
+    return this->parent != nullptr;
+  }
+
+  auto String::hash() const noexcept -> std::size_t
+  {
+    if (!this->hashed) {
+      this->hash_code = std::hash<std::string_view>{}(this->chars);
+      this->hashed    = true;
+    }
+    return this->hash_code;
+  }
+
+  auto String::is_interned() const noexcept -> bool
+  {
+    return this->pool != nullptr;
+  }
+
+  auto String::operator==(const String& other) const noexcept -> bool
+  {
+    if (this == &other) {
+      return true;
+    }
+
+    // interning guarantees one object per distinct string
+    if (this->is_interned() && this->pool == other.pool) {
+      return false;
+    }
+
+    if (this->size() != other.size() || this->hash() != other.hash()) {
+      return false;
+    }
+
+    return this->chars == other.chars;
+  }
+
+  auto String::operator<=>(const String& other) const noexcept -> std::strong_ordering
+  {
+    return this->view() <=> other.view();
   }
 
   Function::Function(std::string n, std::size_t a, std::size_t ip) noexcept
-   : name(n)
+   : Object(Tag::FUNCTION)
+   , name(n)
    , airity(a)
    , instruction_ptr(ip)
   {}
 
+  Function::Function(std::string n, std::size_t a, Source src)
+   : Object(Tag::FUNCTION)
+   , name(n)
+   , airity(a)
+   , instruction_ptr(0)
+   , source(std::make_unique<Source>(std::move(src)))
+  {}
+
   auto Function::to_string() const noexcept -> std::string
   {
-    std::stringstream ss;
-    ss << "<fn " << this->name << '>';
-    return ss.str();
+    return "<fn " + this->name + '>';
+  }
+
+  auto Function::is_compiled() const noexcept -> bool
+  {
+    return this->source == nullptr;
   }
 
   auto operator<<(std::ostream& ostream, const Function& fn) -> std::ostream&
@@ -442,21 +840,29 @@ namespace ss
   }
 
   NativeFunction::NativeFunction(std::string n, std::size_t a, Function f)
-   : name(n)
+   : Object(Tag::NATIVE)
+   , name(n)
    , airity(a)
    , function(f)
   {}
 
   auto NativeFunction::call(std::vector<Value>&& args) -> Value
   {
+    args.insert(args.end(), this->bound.begin(), this->bound.end());
     return function(std::move(args));
   }
 
+  void NativeFunction::bind(Value value)
+  {
+    if (auto collector = Collector::active(); collector != nullptr) {
+      collector->write_barrier(value);
+    }
+    this->bound.push_back(std::move(value));
+  }
+
   auto NativeFunction::to_string() const noexcept -> std::string
   {
-    std::stringstream ss;
-    ss << "<nf " << this->name << '>';
-    return ss.str();
+    return "<nf " + this->name + '>';
   }
 
   auto Value::AddressType::operator==(const AddressType& other) const noexcept -> bool
@@ -1,13 +1,21 @@
 #pragma once
 
+#include "memory.hpp"
+#include "object.hpp"
+
+#include <compare>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 namespace ss
 {
+  class String;
   class Function;
   class NativeFunction;
 
@@ -19,6 +27,7 @@ namespace ss
       Nil,
       Bool,
       Number,
+      Int,
       String,
       Function,
       Native,
@@ -60,9 +69,11 @@ namespace ss
 
     using BoolType           = bool;
     using NumberType         = double;
+    using IntType            = std::int64_t;
     using StringType         = std::string;
-    using FunctionType       = std::shared_ptr<Function>;
-    using NativeFunctionType = std::shared_ptr<NativeFunction>;
+    using StringObjectType   = std::shared_ptr<String>;
+    using FunctionType       = Ref<Function>;
+    using NativeFunctionType = Ref<NativeFunction>;
 
     struct AddressType
     {
@@ -84,7 +95,9 @@ namespace ss
     Value();
     Value(BoolType v);
     Value(NumberType v);
+    Value(IntType v);
     Value(StringType v);
+    Value(StringObjectType v);
     Value(const char* v);
     Value(FunctionType v);
     Value(NativeFunctionType v);
@@ -92,12 +105,40 @@ namespace ss
 
     auto type() const noexcept -> Type;
     auto is_type(Type t) const noexcept -> bool;
+    /**
+     * @brief Check if the value is a number or an integer
+     */
+    auto is_numeric() const noexcept -> bool;
 
     auto boolean() const -> BoolType;
+    /**
+     * @brief Access the value as a number. Integers are converted
+     */
     auto number() const -> NumberType;
+    /**
+     * @brief Access the number without checking the type. Only valid when the value is known to be a number
+     */
+    auto number_unchecked() const noexcept -> NumberType;
+    auto integer() const -> IntType;
+    /**
+     * @brief Access the integer without checking the type. Only valid when the value is known to be an integer
+     */
+    auto integer_unchecked() const noexcept -> IntType;
     auto string() const -> StringType;
+    /**
+     * @brief Access the characters of the string without copying them. Empty when not a string
+     */
+    auto string_view() const noexcept -> std::string_view;
+    /**
+     * @brief Access the shared string object, null when not a string
+     */
+    auto string_object() const -> StringObjectType;
     auto function() const -> FunctionType;
     auto native() const -> NativeFunctionType;
+    /**
+     * @brief The heap object the value refers to, null when it holds none
+     */
+    auto object() const noexcept -> Object*;
     auto address() const -> AddressType;
 
     auto truthy() const -> bool;
@@ -105,18 +146,25 @@ namespace ss
 
     auto operator-() const -> Value;
     auto operator!() const -> Value;
+    auto operator~() const -> Value;
 
     auto operator+(const Value& other) const -> Value;
     auto operator-(const Value& other) const -> Value;
     auto operator*(const Value& other) const -> Value;
     auto operator/(const Value& other) const -> Value;
     auto operator%(const Value& other) const -> Value;
+    auto operator&(const Value& other) const -> Value;
+    auto operator|(const Value& other) const -> Value;
+    auto operator^(const Value& other) const -> Value;
+    auto operator<<(const Value& other) const -> Value;
+    auto operator>>(const Value& other) const -> Value;
 
     auto operator=(NilType v) noexcept -> Value&;
     auto operator=(BoolType b) noexcept -> Value&;
     auto operator=(NumberType v) noexcept -> Value&;
-    auto operator=(StringType v) noexcept -> Value&;
-    auto operator=(const char* v) noexcept -> Value&;
+    auto operator=(IntType v) noexcept -> Value&;
+    auto operator=(StringType v) -> Value&;
+    auto operator=(const char* v) -> Value&;
     auto operator=(FunctionType v) noexcept -> Value&;
     auto operator=(NativeFunctionType v) noexcept -> Value&;
 
@@ -129,28 +177,145 @@ namespace ss
 
     static NilType nil;
 
+    /**
+     * @brief Integer arithmetic wraps around on overflow
+     */
+    static constexpr auto wrapping_add(IntType a, IntType b) noexcept -> IntType
+    {
+      return static_cast<IntType>(static_cast<std::uint64_t>(a) + static_cast<std::uint64_t>(b));
+    }
+
+    static constexpr auto wrapping_sub(IntType a, IntType b) noexcept -> IntType
+    {
+      return static_cast<IntType>(static_cast<std::uint64_t>(a) - static_cast<std::uint64_t>(b));
+    }
+
+    static constexpr auto wrapping_mul(IntType a, IntType b) noexcept -> IntType
+    {
+      return static_cast<IntType>(static_cast<std::uint64_t>(a) * static_cast<std::uint64_t>(b));
+    }
+
+    static constexpr auto wrapping_neg(IntType a) noexcept -> IntType
+    {
+      return static_cast<IntType>(std::uint64_t{0} - static_cast<std::uint64_t>(a));
+    }
+
+    /**
+     * @brief Integer remainder, the result takes the sign of the dividend. By zero it is NaN, as for numbers and as
+     * division by zero gives infinity rather than an error
+     */
+    static auto remainder(IntType a, IntType b) noexcept -> Value;
+
+    /**
+     * @brief Adds the values from left to right. When the first addition involves a string, the result is built with a single
+     * allocation instead of one per addition
+     */
+    static auto concat(std::span<const Value> values) -> Value;
+
    private:
-    std::variant<NilType, BoolType, NumberType, StringType, FunctionType, NativeFunctionType, AddressType> value;
+    std::variant<NilType, BoolType, NumberType, IntType, StringObjectType, FunctionType, NativeFunctionType, AddressType> value;
   };
 
   auto operator<<(std::ostream& ostream, const Value& value) -> std::ostream&;
 
-  class Function
+  /**
+   * @brief Immutable string shared by every value holding it, so copying a value never copies the characters.
+   *
+   * Interned strings are unique within their pool, two interned strings from the same pool are equal only when they are
+   * the same object. A slice borrows a range of another string's characters instead of owning any. Strings made while a
+   * memory tracker is active are charged to it for as long as they live
+   */
+  class String
   {
    public:
+    String(std::string str, const void* pool = nullptr);
+    String(std::shared_ptr<String> parent, std::size_t offset, std::size_t length);
+    String(const String&) = delete;
+    String(String&&)      = delete;
+    ~String();
+
+    auto operator=(const String&) -> String& = delete;
+    auto operator=(String&&) -> String&      = delete;
+
+    /**
+     * @brief Creates a slice of the string without copying characters. The range is clamped to the string
+     */
+    static auto slice(const std::shared_ptr<String>& str, std::size_t offset, std::size_t length) -> std::shared_ptr<String>;
+
+    auto view() const noexcept -> std::string_view;
+    auto size() const noexcept -> std::size_t;
+    auto is_slice() const noexcept -> bool;
+    /**
+     * @brief Hash of the characters, computed on first use
+     */
+    auto hash() const noexcept -> std::size_t;
+    auto is_interned() const noexcept -> bool;
+
+    auto operator==(const String& other) const noexcept -> bool;
+    auto operator<=>(const String& other) const noexcept -> std::strong_ordering;
+
+   private:
+    const std::string data;
+    /**
+     * @brief The string that owns the characters of a slice, null otherwise
+     */
+    const std::shared_ptr<String> parent;
+    const std::string_view chars;
+    const void* const pool;
+    MemoryTracker* const memory;
+    mutable std::size_t hash_code;
+    mutable bool hashed;
+
+    /**
+     * @brief Bytes charged to the memory tracker, the characters are only counted for the string owning them
+     */
+    auto footprint() const noexcept -> std::size_t;
+  };
+
+  class Function: public Object
+  {
+   public:
+    /**
+     * @brief The text of a function whose body has not been compiled yet, from the '(' opening its parameters to the '}'
+     * closing its body
+     */
+    struct Source
+    {
+      std::string text;
+      std::string file;
+      std::size_t line;
+      std::size_t column;
+    };
+
     Function(std::string name, std::size_t airity, std::size_t ip) noexcept;
+    /**
+     * @brief Makes a function whose body is compiled on its first call
+     */
+    Function(std::string name, std::size_t airity, Source source);
     ~Function() = default;
 
     auto to_string() const noexcept -> std::string;
 
+    /**
+     * @brief False until the body of a lazily compiled function has been compiled, instruction_ptr is meaningless until then
+     */
+    auto is_compiled() const noexcept -> bool;
+
     const std::string name;
     const std::size_t airity;
-    const std::size_t instruction_ptr;
+    /**
+     * @brief The instruction before the first one of the body
+     */
+    std::size_t instruction_ptr;
+    /**
+     * @brief Dropped once the body is compiled
+     */
+    std::unique_ptr<Source> source;
   };
 
   auto operator<<(std::ostream& ostream, const Function& fn) -> std::ostream&;
 
-  class NativeFunction
+  class NativeFunction: public Object
   {
    public:
     using Args     = std::vector<Value>;
@@ -159,12 +324,22 @@ namespace ss
     NativeFunction(std::string name, std::size_t airity, Function function);
     ~NativeFunction() = default;
 
+    /**
+     * @brief Calls the function with the arguments followed by the bound values
+     */
     auto call(std::vector<Value>&& args) -> Value;
 
+    /**
+     * @brief Binds a value to pass to every call after its arguments. Values the native keeps go here rather than into
+     * the captures of its function, where the collector cannot see them
+     */
+    void bind(Value value);
+
     auto to_string() const noexcept -> std::string;
 
     const std::string name;
     const std::size_t airity;
     const Function function;
+    std::vector<Value> bound;
   };
 }  // namespace ss
\ No newline at end of file
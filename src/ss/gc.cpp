@@ -0,0 +1,323 @@
+#include "gc.hpp"
+
+namespace ss
+{
+  namespace
+  {
+    thread_local Collector* active_collector = nullptr;
+
+    /**
+     * @brief Units of work between checks of the clock
+     */
+    constexpr std::size_t BATCH_SIZE = 64;
+
+    /**
+     * @brief Calls the function with every object the object holds a reference to
+     */
+    template <typename F>
+    void for_each_child(Object* object, F&& f)
+    {
+      switch (object->tag()) {
+        case Object::Tag::FUNCTION: {
+          // code refers to other functions by constant, never directly
+        } break;
+        case Object::Tag::NATIVE: {
+          for (const auto& value : static_cast<NativeFunction*>(object)->bound) {
+            if (auto child = value.object(); child != nullptr) {
+              f(child);
+            }
+          }
+        } break;
+      }
+    }
+
+    /**
+     * @brief Drops every reference the object holds to other heap objects
+     */
+    void clear_children(Object* object) noexcept
+    {
+      switch (object->tag()) {
+        case Object::Tag::FUNCTION: {
+        } break;
+        case Object::Tag::NATIVE: {
+          static_cast<NativeFunction*>(object)->bound.clear();
+        } break;
+      }
+    }
+
+    auto size_of(Object* object) noexcept -> std::size_t
+    {
+      switch (object->tag()) {
+        case Object::Tag::FUNCTION: {
+          return sizeof(Function);
+        }
+        case Object::Tag::NATIVE: {
+          return sizeof(NativeFunction);
+        }
+      }
+      return 0;
+    }
+
+    void destroy(Object* object) noexcept
+    {
+      switch (object->tag()) {
+        case Object::Tag::FUNCTION: {
+          auto fn = static_cast<Function*>(object);
+          fn->~Function();
+          ObjectPool::deallocate(fn, sizeof(Function));
+        } break;
+        case Object::Tag::NATIVE: {
+          auto fn = static_cast<NativeFunction*>(object);
+          fn->~NativeFunction();
+          ObjectPool::deallocate(fn, sizeof(NativeFunction));
+        } break;
+      }
+    }
+  }  // namespace
+
+  Collector::Collector(std::chrono::microseconds b, RootSource r, RootSource s, MemoryTracker* m) noexcept
+   : budget(b)
+   , roots(std::move(r))
+   , stack(std::move(s))
+   , memory(m)
+   , phase(Phase::IDLE)
+   , objects(nullptr)
+   , cursor(nullptr)
+   , before_cursor(nullptr)
+   , allocated(0)
+   , mark_value(true)
+   , stack_rescanned(false)
+  {}
+
+  Collector::~Collector()
+  {
+    if (active_collector == this) {
+      active_collector = nullptr;
+    }
+
+    // whatever is still referenced from outside goes back to plain reference counting
+    for (Object* object = this->objects; object != nullptr;) {
+      Object* next = object->next_tracked;
+      if (this->memory != nullptr) {
+        this->memory->deallocate(MemoryTracker::Category::FUNCTIONS, size_of(object));
+      }
+      if (object->refs == 0) {
+        destroy(object);
+      } else {
+        object->tracked      = false;
+        object->next_tracked = nullptr;
+      }
+      object = next;
+    }
+  }
+
+  auto Collector::active() noexcept -> Collector*
+  {
+    return active_collector;
+  }
+
+  Collector::Scope::Scope(Collector& collector) noexcept
+   : previous(active_collector)
+  {
+    active_collector = &collector;
+  }
+
+  Collector::Scope::~Scope()
+  {
+    active_collector = this->previous;
+  }
+
+  void Collector::track(Object* object, std::size_t size)
+  {
+    if (this->memory != nullptr) {
+      this->memory->allocate(MemoryTracker::Category::FUNCTIONS, size);
+    }
+
+    // when idle this leaves it unmarked for the next cycle, during one it is born marked
+    object->tracked       = true;
+    object->marked        = this->mark_value;
+    object->internal_refs = 0;
+    object->next_tracked  = this->objects;
+
+    // the new head sits right before the cursor when the cursor is at the head
+    if (this->cursor != nullptr && this->cursor == this->objects && this->before_cursor == nullptr) {
+      this->before_cursor = object;
+    }
+
+    this->objects = object;
+    this->allocated++;
+    this->statistics.tracked++;
+  }
+
+  void Collector::step()
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    if (this->phase == Phase::IDLE) {
+      this->allocated       = 0;
+      this->mark_value      = !this->mark_value;
+      this->stack_rescanned = false;
+      this->phase           = Phase::MARK;
+      this->roots([this](const Value& value) { this->shade(value); });
+      this->stack([this](const Value& value) { this->shade(value); });
+    }
+
+    while (this->phase != Phase::IDLE) {
+      this->advance_phase(BATCH_SIZE);
+      if (this->budget.count() > 0 && std::chrono::steady_clock::now() - start >= this->budget) {
+        break;
+      }
+    }
+
+    auto pause = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    this->statistics.steps++;
+    this->statistics.last_pause = pause;
+    this->statistics.max_pause  = std::max(this->statistics.max_pause, pause);
+    this->statistics.total_pause += pause;
+  }
+
+  void Collector::collect()
+  {
+    auto old_budget = this->budget;
+    this->budget    = std::chrono::microseconds(0);
+
+    if (this->phase != Phase::IDLE) {
+      this->step();
+    }
+    this->step();
+
+    this->budget = old_budget;
+  }
+
+  auto Collector::stats() const noexcept -> const Stats&
+  {
+    return this->statistics;
+  }
+
+  void Collector::shade(const Value& value) noexcept
+  {
+    this->shade(value.object());
+  }
+
+  void Collector::shade(Object* object) noexcept
+  {
+    if (object != nullptr && object->tracked && object->marked != this->mark_value) {
+      object->marked = this->mark_value;
+      this->gray.push_back(object);
+    }
+  }
+
+  auto Collector::drain(std::size_t batch) -> bool
+  {
+    for (; batch > 0 && !this->gray.empty(); batch--) {
+      Object* object = this->gray.back();
+      this->gray.pop_back();
+      for_each_child(object, [this](Object* child) { this->shade(child); });
+    }
+    return !this->gray.empty();
+  }
+
+  void Collector::begin_list_phase(Phase next) noexcept
+  {
+    this->phase         = next;
+    this->cursor        = this->objects;
+    this->before_cursor = nullptr;
+  }
+
+  void Collector::free_object(Object* object) noexcept
+  {
+    if (this->memory != nullptr) {
+      this->memory->deallocate(MemoryTracker::Category::FUNCTIONS, size_of(object));
+    }
+    destroy(object);
+    this->statistics.freed++;
+    this->statistics.tracked--;
+  }
+
+  void Collector::advance_phase(std::size_t batch)
+  {
+    switch (this->phase) {
+      case Phase::IDLE: {
+      } break;
+      case Phase::MARK: {
+        if (this->drain(batch)) {
+          return;
+        }
+        if (!this->stack_rescanned) {
+          // locals are stored without a barrier, whatever they picked up since the cycle began is found here
+          this->stack_rescanned = true;
+          this->stack([this](const Value& value) { this->shade(value); });
+          return;
+        }
+        this->begin_list_phase(Phase::SCAN);
+      } break;
+      case Phase::SCAN: {
+        for (; batch > 0 && this->cursor != nullptr; batch--) {
+          Object* object = this->cursor;
+          if (object->marked != this->mark_value) {
+            for_each_child(object, [](Object* child) { child->internal_refs++; });
+          }
+          this->cursor = object->next_tracked;
+        }
+        if (this->cursor == nullptr) {
+          this->begin_list_phase(Phase::RESCUE);
+        }
+      } break;
+      case Phase::RESCUE: {
+        if (this->drain(batch)) {
+          return;
+        }
+        for (; batch > 0 && this->cursor != nullptr; batch--) {
+          Object* object = this->cursor;
+          // held from somewhere other than the heap, by the host or a native
+          if (object->marked != this->mark_value && object->refs > object->internal_refs) {
+            this->shade(object);
+          }
+          this->cursor = object->next_tracked;
+        }
+        if (this->cursor == nullptr && this->gray.empty()) {
+          this->begin_list_phase(Phase::CLEAR);
+        }
+      } break;
+      case Phase::CLEAR: {
+        for (; batch > 0 && this->cursor != nullptr; batch--) {
+          Object* object = this->cursor;
+          // clearing one object drops the counts of the others, whether garbage was referenced is what scanning found
+          if (object->marked != this->mark_value) {
+            if (object->internal_refs > 0) {
+              this->statistics.freed_in_cycles++;
+            }
+            clear_children(object);
+          }
+          this->cursor = object->next_tracked;
+        }
+        if (this->cursor == nullptr) {
+          this->begin_list_phase(Phase::SWEEP);
+        }
+      } break;
+      case Phase::SWEEP: {
+        for (; batch > 0 && this->cursor != nullptr; batch--) {
+          Object* object = this->cursor;
+          Object* next   = object->next_tracked;
+          if (object->refs == 0) {
+            if (this->before_cursor == nullptr) {
+              this->objects = next;
+            } else {
+              this->before_cursor->next_tracked = next;
+            }
+            this->free_object(object);
+          } else {
+            object->internal_refs = 0;
+            this->before_cursor   = object;
+          }
+          this->cursor = next;
+        }
+        if (this->cursor == nullptr) {
+          this->phase         = Phase::IDLE;
+          this->before_cursor = nullptr;
+          this->statistics.cycles++;
+        }
+      } break;
+    }
+  }
+}  // namespace ss
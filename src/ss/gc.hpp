@@ -0,0 +1,188 @@
+#pragma once
+
+#include "datatypes.hpp"
+#include "memory.hpp"
+#include "object.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ss
+{
+  /**
+   * @brief Incremental mark-sweep collector for the heap objects of one VM.
+   *
+   * Reference counts stay exact for acyclic data, what the collector adds is reclaiming cycles and bounding the time spent
+   * freeing. An object whose count drops to zero is left for the sweep, so dropping a large graph never stalls the script.
+   * A cycle starts by marking everything reachable from the roots. Of the objects left unmarked, those referenced from
+   * outside the heap are found by subtracting the references they hold among each other from their counts, and they are
+   * marked as well. What remains is only referenced by other garbage, its references are dropped and the sweep frees it.
+   * Natives are what hold references, through their bound values. Strings are left to their own counts, a slice only
+   * refers to the string owning its characters, which never closes a cycle.
+   *
+   * Every phase runs in slices that stop once the pause budget is spent. Objects made during a cycle are born marked, values
+   * stored into globals while a cycle runs are marked by the write barrier, and the value stack is scanned again before
+   * marking ends, so stores to locals need no barrier
+   */
+  class Collector
+  {
+   public:
+    struct Stats
+    {
+      /**
+       * @brief Collection cycles finished
+       */
+      std::size_t cycles = 0;
+      /**
+       * @brief Slices run, each one is a single pause
+       */
+      std::size_t steps = 0;
+      /**
+       * @brief Objects currently owned by the collector
+       */
+      std::size_t tracked = 0;
+      /**
+       * @brief Objects freed over the life of the collector
+       */
+      std::size_t freed = 0;
+      /**
+       * @brief Objects freed while other garbage still referred to them, as the objects of a cycle do
+       */
+      std::size_t freed_in_cycles = 0;
+      std::chrono::microseconds last_pause{0};
+      std::chrono::microseconds max_pause{0};
+      std::chrono::microseconds total_pause{0};
+    };
+
+    /**
+     * @brief Calls the visitor with every root value
+     */
+    using RootSource = std::function<void(const std::function<void(const Value&)>&)>;
+
+    /**
+     * @brief Objects made since the last cycle after which a new one is started
+     */
+    static constexpr std::size_t ALLOCATION_THRESHOLD = 256;
+
+    /**
+     * @param pause_budget Time a single slice may take. Zero runs each cycle to completion in one slice
+     * @param roots The constants and globals of the VM
+     * @param stack The value stack of the VM, scanned again at the end of marking
+     * @param memory Where tracked objects are charged to, if anywhere
+     */
+    Collector(
+     std::chrono::microseconds pause_budget, RootSource roots, RootSource stack, MemoryTracker* memory = nullptr) noexcept;
+    ~Collector();
+
+    Collector(const Collector&) = delete;
+    Collector(Collector&&)      = delete;
+
+    auto operator=(const Collector&) -> Collector& = delete;
+    auto operator=(Collector&&) -> Collector&      = delete;
+
+    /**
+     * @brief The collector objects made on this thread are given to, if any
+     */
+    static auto active() noexcept -> Collector*;
+
+    /**
+     * @brief Makes the collector active on this thread for the lifetime of the scope
+     */
+    class Scope
+    {
+     public:
+      explicit Scope(Collector& collector) noexcept;
+      ~Scope();
+
+      Scope(const Scope&) = delete;
+      auto operator=(const Scope&) -> Scope& = delete;
+
+     private:
+      Collector* previous;
+    };
+
+    /**
+     * @throws RuntimeError When the memory limit does not leave room for the object, it is not tracked then
+     */
+    void track(Object* object, std::size_t size);
+
+    /**
+     * @brief True when a cycle is running or enough objects were made to start one
+     */
+    auto wants_step() const noexcept -> bool
+    {
+      return this->phase != Phase::IDLE || this->allocated >= ALLOCATION_THRESHOLD;
+    }
+
+    /**
+     * @brief Runs the collector until the pause budget is spent or the cycle finishes
+     */
+    void step();
+
+    /**
+     * @brief Runs a full cycle, finishing the one in progress first if there is one
+     */
+    void collect();
+
+    /**
+     * @brief Must be called with every value stored into a global or a heap object, such as a value bound to a native
+     */
+    void write_barrier(const Value& value) noexcept
+    {
+      if (this->phase != Phase::IDLE) {
+        this->shade(value);
+      }
+    }
+
+    auto stats() const noexcept -> const Stats&;
+
+   private:
+    enum class Phase
+    {
+      IDLE,
+      MARK,
+      SCAN,
+      RESCUE,
+      CLEAR,
+      SWEEP,
+    };
+
+    std::chrono::microseconds budget;
+    RootSource roots;
+    RootSource stack;
+    MemoryTracker* memory;
+    Phase phase;
+    Object* objects;
+    std::vector<Object*> gray;
+    /**
+     * @brief The next object the current phase visits, along with the one before it for unlinking
+     */
+    Object* cursor;
+    Object* before_cursor;
+    std::size_t allocated;
+    /**
+     * @brief What the mark flag of a reached object is set to, flipped every cycle so marks never need to be reset
+     */
+    bool mark_value;
+    bool stack_rescanned;
+    Stats statistics;
+
+    void shade(const Value& value) noexcept;
+    void shade(Object* object) noexcept;
+    /**
+     * @brief Runs at most a batch of work in the current phase, moving on to the next one when it is done
+     */
+    void advance_phase(std::size_t batch);
+    /**
+     * @brief Traces gray objects
+     *
+     * @return True if some are left
+     */
+    auto drain(std::size_t batch) -> bool;
+    void begin_list_phase(Phase next) noexcept;
+    void free_object(Object* object) noexcept;
+  };
+}  // namespace ss
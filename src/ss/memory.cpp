@@ -0,0 +1,93 @@
+#include "memory.hpp"
+
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ss
+{
+  namespace
+  {
+    thread_local MemoryTracker* active_tracker = nullptr;
+  }  // namespace
+
+  MemoryTracker::MemoryTracker(std::size_t limit) noexcept
+   : bytes{}
+   , total_bytes(0)
+   , peak_bytes(0)
+   , max_bytes(limit)
+   , released(false)
+  {}
+
+  void MemoryTracker::allocate(Category category, std::size_t n)
+  {
+    if (this->max_bytes != UNLIMITED && n > this->max_bytes - std::min(this->total_bytes, this->max_bytes)) {
+      RuntimeError::throw_err(
+       "memory limit of ", this->max_bytes, " bytes exceeded, ", this->total_bytes, " in use and ", n, " more needed for ",
+       to_string(category));
+    }
+
+    this->bytes[static_cast<std::size_t>(category)] += n;
+    this->total_bytes += n;
+    this->peak_bytes = std::max(this->peak_bytes, this->total_bytes);
+  }
+
+  void MemoryTracker::deallocate(Category category, std::size_t n) noexcept
+  {
+    this->bytes[static_cast<std::size_t>(category)] -= n;
+    this->total_bytes -= n;
+
+    // the last string outliving the owner
+    if (this->released && this->total_bytes == 0) {
+      delete this;
+    }
+  }
+
+  auto MemoryTracker::used(Category category) const noexcept -> std::size_t
+  {
+    return this->bytes[static_cast<std::size_t>(category)];
+  }
+
+  auto MemoryTracker::total() const noexcept -> std::size_t
+  {
+    return this->total_bytes;
+  }
+
+  auto MemoryTracker::peak() const noexcept -> std::size_t
+  {
+    return this->peak_bytes;
+  }
+
+  auto MemoryTracker::limit() const noexcept -> std::size_t
+  {
+    return this->max_bytes;
+  }
+
+  auto MemoryTracker::active() noexcept -> MemoryTracker*
+  {
+    return active_tracker;
+  }
+
+  MemoryTracker::Scope::Scope(MemoryTracker& tracker) noexcept
+   : previous(std::exchange(active_tracker, &tracker))
+  {}
+
+  MemoryTracker::Scope::~Scope()
+  {
+    active_tracker = this->previous;
+  }
+
+  void MemoryTracker::Release::operator()(MemoryTracker* tracker) const noexcept
+  {
+    if (active_tracker == tracker) {
+      active_tracker = nullptr;
+    }
+
+    if (tracker->total_bytes == 0) {
+      delete tracker;
+    } else {
+      tracker->released = true;
+    }
+  }
+}  // namespace ss
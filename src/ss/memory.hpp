@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+namespace ss
+{
+  /**
+   * @brief Counts the bytes a VM holds, by category, and enforces its memory limit
+   */
+  class MemoryTracker
+  {
+   public:
+    enum class Category
+    {
+      STACK,
+      CONSTANTS,
+      STRINGS,
+      FUNCTIONS,
+      GLOBALS,
+      LAST,
+    };
+
+    static constexpr std::size_t UNLIMITED = 0;
+
+    explicit MemoryTracker(std::size_t limit = UNLIMITED) noexcept;
+
+    /**
+     * @brief Records an allocation
+     *
+     * @throws RuntimeError Without recording anything, when the allocation would take the total over the limit
+     */
+    void allocate(Category category, std::size_t bytes);
+    void deallocate(Category category, std::size_t bytes) noexcept;
+
+    auto used(Category category) const noexcept -> std::size_t;
+    auto total() const noexcept -> std::size_t;
+    /**
+     * @brief The highest the total has been
+     */
+    auto peak() const noexcept -> std::size_t;
+    auto limit() const noexcept -> std::size_t;
+
+    /**
+     * @brief The tracker strings made on this thread are charged to, if any
+     */
+    static auto active() noexcept -> MemoryTracker*;
+
+    /**
+     * @brief Makes the tracker active on this thread for the lifetime of the scope
+     */
+    class Scope
+    {
+     public:
+      explicit Scope(MemoryTracker& tracker) noexcept;
+      ~Scope();
+
+      Scope(const Scope&) = delete;
+      auto operator=(const Scope&) -> Scope& = delete;
+
+     private:
+      MemoryTracker* previous;
+    };
+
+    /**
+     * @brief Gives up a heap allocated tracker. Strings charged to it may outlive its owner, so it is only deleted once
+     * nothing is charged to it anymore
+     */
+    struct Release
+    {
+      void operator()(MemoryTracker* tracker) const noexcept;
+    };
+
+    using Owner = std::unique_ptr<MemoryTracker, Release>;
+
+   private:
+    std::array<std::size_t, static_cast<std::size_t>(Category::LAST)> bytes;
+    std::size_t total_bytes;
+    std::size_t peak_bytes;
+    std::size_t max_bytes;
+    bool released;
+  };
+
+  constexpr auto to_string(MemoryTracker::Category category) noexcept -> const char*
+  {
+    switch (category) {
+      case MemoryTracker::Category::STACK: {
+        return "stack";
+      }
+      case MemoryTracker::Category::CONSTANTS: {
+        return "constants";
+      }
+      case MemoryTracker::Category::STRINGS: {
+        return "strings";
+      }
+      case MemoryTracker::Category::FUNCTIONS: {
+        return "functions";
+      }
+      case MemoryTracker::Category::GLOBALS: {
+        return "globals";
+      }
+      default: {
+        return "unknown";
+      }
+    }
+  }
+
+  /**
+   * @brief Standard allocator that charges what it hands out to a tracker. Without a tracker it only allocates
+   */
+  template <typename T, MemoryTracker::Category C>
+  class TrackingAllocator
+  {
+   public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+      using other = TrackingAllocator<U, C>;
+    };
+
+    TrackingAllocator(MemoryTracker* t = nullptr) noexcept
+     : tracker(t)
+    {}
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, C>& other) noexcept
+     : tracker(other.tracker)
+    {}
+
+    auto allocate(std::size_t n) -> T*
+    {
+      if (this->tracker != nullptr) {
+        this->tracker->allocate(C, n * sizeof(T));
+      }
+      try {
+        return std::allocator<T>{}.allocate(n);
+      } catch (...) {
+        if (this->tracker != nullptr) {
+          this->tracker->deallocate(C, n * sizeof(T));
+        }
+        throw;
+      }
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+      if (this->tracker != nullptr) {
+        this->tracker->deallocate(C, n * sizeof(T));
+      }
+      std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    template <typename U>
+    auto operator==(const TrackingAllocator<U, C>& other) const noexcept -> bool
+    {
+      return this->tracker == other.tracker;
+    }
+
+    MemoryTracker* tracker;
+  };
+}  // namespace ss
@@ -0,0 +1,90 @@
+#include "object.hpp"
+
+#include "gc.hpp"
+
+namespace ss
+{
+  Object::Object(Tag t) noexcept
+   : refs(0)
+   , internal_refs(0)
+   , next_tracked(nullptr)
+   , type_tag(t)
+   , tracked(false)
+   , marked(false)
+  {}
+
+  void Object::track(Object* object, std::size_t size)
+  {
+    if (auto collector = Collector::active(); collector != nullptr) {
+      collector->track(object, size);
+    }
+  }
+
+  auto Object::tag() const noexcept -> Tag
+  {
+    return this->type_tag;
+  }
+
+  auto Object::ref_count() const noexcept -> std::uint32_t
+  {
+    return this->refs;
+  }
+
+  auto ObjectPool::instance() noexcept -> ObjectPool&
+  {
+    // never destroyed, objects held by other statics may be released after this would have been
+    static ObjectPool* pool = new ObjectPool();
+    return *pool;
+  }
+
+  auto ObjectPool::allocate(std::size_t size) -> void*
+  {
+    auto size_class = class_of(size);
+    if (size_class == CLASS_COUNT) {
+      return ::operator new(size);
+    }
+
+    auto& pool = instance();
+    std::lock_guard<std::mutex> guard(pool.lock);
+
+    if (pool.free_lists[size_class] == nullptr) {
+      pool.refill(size_class);
+    }
+
+    FreeBlock* block            = pool.free_lists[size_class];
+    pool.free_lists[size_class] = block->next;
+    return block;
+  }
+
+  void ObjectPool::deallocate(void* ptr, std::size_t size) noexcept
+  {
+    auto size_class = class_of(size);
+    if (size_class == CLASS_COUNT) {
+      ::operator delete(ptr);
+      return;
+    }
+
+    auto& pool = instance();
+    std::lock_guard<std::mutex> guard(pool.lock);
+
+    auto block                  = static_cast<FreeBlock*>(ptr);
+    block->next                 = pool.free_lists[size_class];
+    pool.free_lists[size_class] = block;
+  }
+
+  void ObjectPool::refill(std::size_t size_class)
+  {
+    std::size_t block_size = (size_class + 1) * GRANULARITY;
+    auto slab              = static_cast<std::byte*>(::operator new(block_size * BLOCKS_PER_SLAB));
+    this->slabs.push_back(slab);
+
+    // thread the blocks in address order so consecutive allocations are adjacent
+    FreeBlock* head = this->free_lists[size_class];
+    for (std::size_t i = BLOCKS_PER_SLAB; i > 0; i--) {
+      auto block  = reinterpret_cast<FreeBlock*>(slab + (i - 1) * block_size);
+      block->next = head;
+      head        = block;
+    }
+    this->free_lists[size_class] = head;
+  }
+}  // namespace ss
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ss
+{
+  /**
+   * @brief Header shared by every heap allocated value type. Holds the reference count and a tag naming the concrete type.
+   *
+   * The count is not atomic, a value must not be shared between threads that use it at the same time. Objects created
+   * while a collector is active are tracked by it, and freeing them once their count drops to zero is left to its sweep
+   */
+  class Object
+  {
+   public:
+    enum class Tag : std::uint8_t
+    {
+      FUNCTION,
+      NATIVE,
+    };
+
+    Object(const Object&) = delete;
+    Object(Object&&)      = delete;
+
+    auto operator=(const Object&) -> Object& = delete;
+    auto operator=(Object&&) -> Object&      = delete;
+
+    auto tag() const noexcept -> Tag;
+    auto ref_count() const noexcept -> std::uint32_t;
+
+   protected:
+    explicit Object(Tag tag) noexcept;
+    ~Object() = default;
+
+   private:
+    mutable std::uint32_t refs;
+    /**
+     * @brief References held by other unreachable objects, counted by the collector when looking for cycles
+     */
+    std::uint32_t internal_refs;
+    Object* next_tracked;
+    const Tag type_tag;
+    bool tracked;
+    bool marked;
+
+    /**
+     * @brief Hands a newly made object to the active collector, if there is one
+     *
+     * @throws RuntimeError When the memory limit of the collector's VM does not leave room for it
+     */
+    static void track(Object* object, std::size_t size);
+
+    template <typename T>
+    friend class Ref;
+    friend class Collector;
+  };
+
+  /**
+   * @brief Fixed size blocks for heap objects, one free list per size class. Sizes past the last class go to the global
+   * allocator.
+   *
+   * Memory is carved out of slabs that are kept for the life of the program, so a freed block is always reused by the next
+   * object of its class. Only allocation and deallocation lock, copying a reference never does
+   */
+  class ObjectPool
+  {
+   public:
+    static constexpr std::size_t GRANULARITY     = 16;
+    static constexpr std::size_t CLASS_COUNT     = 8;
+    static constexpr std::size_t BLOCKS_PER_SLAB = 64;
+
+    static auto allocate(std::size_t size) -> void*;
+    static void deallocate(void* ptr, std::size_t size) noexcept;
+
+    /**
+     * @brief The size class a block of the given size is served from, CLASS_COUNT if it is too big for any
+     */
+    static constexpr auto class_of(std::size_t size) noexcept -> std::size_t
+    {
+      return size == 0 ? 0 : std::min((size - 1) / GRANULARITY, CLASS_COUNT);
+    }
+
+   private:
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    std::mutex lock;
+    std::array<FreeBlock*, CLASS_COUNT> free_lists{};
+    std::vector<std::byte*> slabs;
+
+    ObjectPool() = default;
+
+    static auto instance() noexcept -> ObjectPool&;
+    void refill(std::size_t size_class);
+  };
+
+  /**
+   * @brief Owning handle to a heap object. Copies adjust the object's count in place, no separate control block exists
+   */
+  template <typename T>
+  class Ref
+  {
+   public:
+    constexpr Ref() noexcept = default;
+    constexpr Ref(std::nullptr_t) noexcept {}
+
+    Ref(const Ref& other) noexcept
+     : object(other.object)
+    {
+      this->retain();
+    }
+
+    Ref(Ref&& other) noexcept
+     : object(std::exchange(other.object, nullptr))
+    {}
+
+    ~Ref()
+    {
+      this->release();
+    }
+
+    auto operator=(const Ref& other) noexcept -> Ref&
+    {
+      if (this->object != other.object) {
+        other.retain();
+        this->release();
+        this->object = other.object;
+      }
+      return *this;
+    }
+
+    auto operator=(Ref&& other) noexcept -> Ref&
+    {
+      if (this != &other) {
+        this->release();
+        this->object = std::exchange(other.object, nullptr);
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Constructs the object in a block from the pool
+     */
+    template <typename... Args>
+    static auto make(Args&&... args) -> Ref
+    {
+      void* block = ObjectPool::allocate(sizeof(T));
+      T* object   = nullptr;
+      try {
+        object = new (block) T(std::forward<Args>(args)...);
+      } catch (...) {
+        ObjectPool::deallocate(block, sizeof(T));
+        throw;
+      }
+      // owned before tracking, should tracking throw the object is released untracked
+      Ref ref(object);
+      Object::track(object, sizeof(T));
+      return ref;
+    }
+
+    auto get() const noexcept -> T*
+    {
+      return this->object;
+    }
+
+    auto operator->() const noexcept -> T*
+    {
+      return this->object;
+    }
+
+    auto operator*() const noexcept -> T&
+    {
+      return *this->object;
+    }
+
+    explicit operator bool() const noexcept
+    {
+      return this->object != nullptr;
+    }
+
+    auto use_count() const noexcept -> std::uint32_t
+    {
+      return this->object == nullptr ? 0 : this->object->refs;
+    }
+
+    friend auto operator==(const Ref& a, const Ref& b) noexcept -> bool
+    {
+      return a.object == b.object;
+    }
+
+    friend auto operator<=>(const Ref& a, const Ref& b) noexcept -> std::strong_ordering
+    {
+      return std::compare_three_way{}(a.object, b.object);
+    }
+
+   private:
+    T* object = nullptr;
+
+    explicit Ref(T* obj) noexcept
+     : object(obj)
+    {
+      this->retain();
+    }
+
+    void retain() const noexcept
+    {
+      if (this->object != nullptr) {
+        this->object->refs++;
+      }
+    }
+
+    void release() noexcept
+    {
+      if (this->object != nullptr && --this->object->refs == 0 && !this->object->tracked) {
+        this->object->~T();
+        ObjectPool::deallocate(this->object, sizeof(T));
+      }
+      this->object = nullptr;
+    }
+  };
+
+  /**
+   * @brief Allocates a heap object from the pool, the counterpart of std::make_shared
+   */
+  template <typename T, typename... Args>
+  auto make_ref(Args&&... args) -> Ref<T>
+  {
+    return Ref<T>::make(std::forward<Args>(args)...);
+  }
+}  // namespace ss
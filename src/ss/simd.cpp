@@ -0,0 +1,233 @@
+#include "simd.hpp"
+
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#  define SS_SIMD_X86 1
+#  include <immintrin.h>
+#else
+#  define SS_SIMD_X86 0
+#endif
+
+namespace ss
+{
+  namespace simd
+  {
+    namespace
+    {
+      template <CharClass C>
+      constexpr auto in_class(char c) noexcept -> bool
+      {
+        if constexpr (C == CharClass::WHITESPACE) {
+          return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        } else if constexpr (C == CharClass::IDENTIFIER) {
+          return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '@';
+        } else if constexpr (C == CharClass::STRING_BODY) {
+          return c != '"';
+        } else {
+          return c != '\n';
+        }
+      }
+
+      template <CharClass C>
+      auto skip_scalar(const char* begin, const char* end) noexcept -> const char*
+      {
+        while (begin < end && in_class<C>(*begin)) { begin++; }
+        return begin;
+      }
+
+      auto count_newlines_scalar(const char* begin, const char* end) noexcept -> std::size_t
+      {
+        std::size_t count = 0;
+        for (; begin < end; begin++) { count += *begin == '\n'; }
+        return count;
+      }
+
+#if SS_SIMD_X86
+      /**
+       * @brief Mask of the bytes in [lo, hi], bytes past 0x7f are never in range since the comparisons are signed
+       */
+      auto in_range_sse2(__m128i v, char lo, char hi) noexcept -> __m128i
+      {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+      }
+
+      /**
+       * @brief One bit per byte of the block, set for the bytes in the class
+       */
+      template <CharClass C>
+      auto class_mask_sse2(const char* p) noexcept -> unsigned
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i m;
+        if constexpr (C == CharClass::WHITESPACE) {
+          m = _mm_or_si128(
+           _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+           _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+        } else if constexpr (C == CharClass::IDENTIFIER) {
+          // setting bit 5 folds upper case onto lower case without pulling anything else into a-z
+          __m128i alpha = in_range_sse2(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+          __m128i digit = in_range_sse2(v, '0', '9');
+          __m128i other = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('@')));
+          m             = _mm_or_si128(_mm_or_si128(alpha, digit), other);
+        } else if constexpr (C == CharClass::STRING_BODY) {
+          return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')))) & 0xFFFF;
+        } else {
+          return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))) & 0xFFFF;
+        }
+        return static_cast<unsigned>(_mm_movemask_epi8(m));
+      }
+
+      template <CharClass C>
+      auto skip_sse2(const char* begin, const char* end) noexcept -> const char*
+      {
+        for (; end - begin >= 16; begin += 16) {
+          unsigned outside = ~class_mask_sse2<C>(begin) & 0xFFFF;
+          if (outside != 0) {
+            return begin + __builtin_ctz(outside);
+          }
+        }
+        return skip_scalar<C>(begin, end);
+      }
+
+      auto count_newlines_sse2(const char* begin, const char* end) noexcept -> std::size_t
+      {
+        std::size_t count = 0;
+        for (; end - begin >= 16; begin += 16) {
+          __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+          count += __builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))));
+        }
+        return count + count_newlines_scalar(begin, end);
+      }
+
+      __attribute__((target("avx2"))) auto in_range_avx2(__m256i v, char lo, char hi) noexcept -> __m256i
+      {
+        return _mm256_and_si256(
+         _mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+      }
+
+      template <CharClass C>
+      __attribute__((target("avx2"))) auto class_mask_avx2(const char* p) noexcept -> std::uint32_t
+      {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i m;
+        if constexpr (C == CharClass::WHITESPACE) {
+          m = _mm256_or_si256(
+           _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+           _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+        } else if constexpr (C == CharClass::IDENTIFIER) {
+          __m256i alpha = in_range_avx2(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+          __m256i digit = in_range_avx2(v, '0', '9');
+          __m256i other =
+           _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('@')));
+          m = _mm256_or_si256(_mm256_or_si256(alpha, digit), other);
+        } else if constexpr (C == CharClass::STRING_BODY) {
+          return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))));
+        } else {
+          return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+        }
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(m));
+      }
+
+      template <CharClass C>
+      __attribute__((target("avx2"))) auto skip_avx2(const char* begin, const char* end) noexcept -> const char*
+      {
+        for (; end - begin >= 32; begin += 32) {
+          std::uint32_t outside = ~class_mask_avx2<C>(begin);
+          if (outside != 0) {
+            return begin + __builtin_ctz(outside);
+          }
+        }
+        return skip_sse2<C>(begin, end);
+      }
+
+      __attribute__((target("avx2"))) auto count_newlines_avx2(const char* begin, const char* end) noexcept -> std::size_t
+      {
+        std::size_t count = 0;
+        for (; end - begin >= 32; begin += 32) {
+          __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+          count +=
+           __builtin_popcount(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')))));
+        }
+        return count + count_newlines_sse2(begin, end);
+      }
+#endif
+
+      auto detect() noexcept -> Isa
+      {
+#if SS_SIMD_X86
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? Isa::AVX2 : Isa::SSE2;
+#else
+        return Isa::SCALAR;
+#endif
+      }
+
+      const Isa DETECTED = detect();
+
+      template <CharClass C>
+      auto skip_with(Isa isa, const char* begin, const char* end) noexcept -> const char*
+      {
+        switch (isa) {
+#if SS_SIMD_X86
+          case Isa::AVX2: {
+            return skip_avx2<C>(begin, end);
+          }
+          case Isa::SSE2: {
+            return skip_sse2<C>(begin, end);
+          }
+#endif
+          default: {
+            return skip_scalar<C>(begin, end);
+          }
+        }
+      }
+    }  // namespace
+
+    auto best_isa() noexcept -> Isa
+    {
+      return DETECTED;
+    }
+
+    auto is_supported(Isa isa) noexcept -> bool
+    {
+      return static_cast<int>(isa) <= static_cast<int>(DETECTED);
+    }
+
+    auto skip(CharClass cls, const char* begin, const char* end, Isa isa) noexcept -> const char*
+    {
+      switch (cls) {
+        case CharClass::WHITESPACE: {
+          return skip_with<CharClass::WHITESPACE>(isa, begin, end);
+        }
+        case CharClass::IDENTIFIER: {
+          return skip_with<CharClass::IDENTIFIER>(isa, begin, end);
+        }
+        case CharClass::STRING_BODY: {
+          return skip_with<CharClass::STRING_BODY>(isa, begin, end);
+        }
+        case CharClass::COMMENT: {
+          return skip_with<CharClass::COMMENT>(isa, begin, end);
+        }
+      }
+      return begin;
+    }
+
+    auto count_newlines(const char* begin, const char* end, Isa isa) noexcept -> std::size_t
+    {
+      switch (isa) {
+#if SS_SIMD_X86
+        case Isa::AVX2: {
+          return count_newlines_avx2(begin, end);
+        }
+        case Isa::SSE2: {
+          return count_newlines_sse2(begin, end);
+        }
+#endif
+        default: {
+          return count_newlines_scalar(begin, end);
+        }
+      }
+    }
+  }  // namespace simd
+}  // namespace ss
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+
+namespace ss
+{
+  namespace simd
+  {
+    /**
+     * @brief Instruction sets the scanning routines have implementations for
+     */
+    enum class Isa
+    {
+      SCALAR,
+      SSE2,
+      AVX2,
+    };
+
+    /**
+     * @brief Runs of characters the scanner skips over in one go
+     */
+    enum class CharClass
+    {
+      /**
+       * @brief Spaces, tabs, carriage returns and newlines
+       */
+      WHITESPACE,
+      /**
+       * @brief Letters, digits, '_' and '@'
+       */
+      IDENTIFIER,
+      /**
+       * @brief Anything but '"'
+       */
+      STRING_BODY,
+      /**
+       * @brief Anything but a newline
+       */
+      COMMENT,
+    };
+
+    /**
+     * @brief The widest instruction set the running CPU supports, detected once
+     */
+    auto best_isa() noexcept -> Isa;
+
+    auto is_supported(Isa isa) noexcept -> bool;
+
+    /**
+     * @brief Finds the end of the run of characters of the class starting at begin. The isa must be supported
+     *
+     * @return The first character not in the class, end if there is none
+     */
+    auto skip(CharClass cls, const char* begin, const char* end, Isa isa = best_isa()) noexcept -> const char*;
+
+    /**
+     * @brief Counts the newlines in the range. The isa must be supported
+     */
+    auto count_newlines(const char* begin, const char* end, Isa isa = best_isa()) noexcept -> std::size_t;
+  }  // namespace simd
+}  // namespace ss
@@ -1,5 +1,6 @@
 #include "util.hpp"
 
+#include <charconv>
 #include <fstream>
 
 namespace ss
@@ -14,5 +15,44 @@ namespace ss
       std::copy(input_iter, empty_iter, string_inserter);
       return contents;
     }
+
+    Arena::Arena() noexcept
+     : memory(this->buffer, INLINE_SIZE)
+     , bytes(0)
+    {}
+
+    auto Arena::allocated() const noexcept -> std::size_t
+    {
+      return this->bytes;
+    }
+
+    auto Arena::do_allocate(std::size_t n, std::size_t alignment) -> void*
+    {
+      this->bytes += n;
+      return this->memory.allocate(n, alignment);
+    }
+
+    void Arena::do_deallocate(void*, std::size_t, std::size_t)
+    {
+      // released with the arena
+    }
+
+    auto Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool
+    {
+      return this == &other;
+    }
+
+    auto format_number(double value, NumberBuffer& buffer) noexcept -> std::string_view
+    {
+      // general notation with a precision of 6 is the default for streams, matching it keeps script output unchanged
+      auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, std::chars_format::general, 6);
+      return std::string_view(buffer.data(), result.ptr - buffer.data());
+    }
+
+    auto format_number(std::int64_t value, NumberBuffer& buffer) noexcept -> std::string_view
+    {
+      auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+      return std::string_view(buffer.data(), result.ptr - buffer.data());
+    }
   }  // namespace util
 }  // namespace ss
@@ -1,11 +1,86 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
 #include <istream>
+#include <memory_resource>
+#include <string_view>
 
 namespace ss
 {
   namespace util
   {
     auto stream_to_string(std::istream& filename) -> std::string;
+
+    /**
+     * @brief Scratch space big enough for any formatted number
+     */
+    using NumberBuffer = std::array<char, 32>;
+
+    /**
+     * @brief Formats the number exactly like an ostream with default settings does, without the stream
+     *
+     * @return The formatted characters, which live in the buffer
+     */
+    auto format_number(double value, NumberBuffer& buffer) noexcept -> std::string_view;
+
+    /**
+     * @brief Formats the integer exactly like an ostream with default settings does, without the stream
+     *
+     * @return The formatted characters, which live in the buffer
+     */
+    auto format_number(std::int64_t value, NumberBuffer& buffer) noexcept -> std::string_view;
+
+    /**
+     * @brief Hash for string keyed containers, lets them be searched with a string view without making a copy
+     */
+    struct StringHash
+    {
+      using is_transparent = void;
+
+      auto operator()(std::string_view str) const noexcept -> std::size_t
+      {
+        return std::hash<std::string_view>{}(str);
+      }
+    };
+
+    /**
+     * @brief Bump allocator for data that lives exactly as long as one compilation.
+     *
+     * Memory is never given back one allocation at a time, everything is released at once when the arena is destroyed.
+     * Small compilations are served entirely from the inline buffer and never reach the heap
+     */
+    class Arena: public std::pmr::memory_resource
+    {
+     public:
+      /**
+       * @brief Every load compiles the file with an arena of its own on the stack, nested loads have to afford one each
+       */
+      static constexpr std::size_t INLINE_SIZE = 4 * 1024;
+
+      Arena() noexcept;
+      Arena(const Arena&) = delete;
+      Arena(Arena&&)      = delete;
+      ~Arena() override   = default;
+
+      auto operator=(const Arena&) -> Arena& = delete;
+      auto operator=(Arena&&) -> Arena&      = delete;
+
+      /**
+       * @brief Total bytes handed out so far, including memory abandoned by containers that grew
+       */
+      auto allocated() const noexcept -> std::size_t;
+
+     private:
+      alignas(std::max_align_t) std::byte buffer[INLINE_SIZE];
+      std::pmr::monotonic_buffer_resource memory;
+      std::size_t bytes;
+
+      auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override;
+      void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+      auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override;
+    };
   }  // namespace util
 }  // namespace ss
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "vm.hpp"
 
+#include "builtins.hpp"
+#include "bytecode.hpp"
 #include "exceptions.hpp"
 #include "util.hpp"
 
+#include <cmath>
 #include <exception>
 #include <fstream>
 #include <iomanip>
@@ -20,13 +23,162 @@
 
 namespace ss
 {
+  namespace
+  {
+    /**
+     * @brief Applies the binary operator of a register instruction
+     */
+    auto binary_op(OpCode op, const Value& a, const Value& b) -> Value
+    {
+      switch (op) {
+        case OpCode::EQUAL: {
+          return a == b;
+        }
+        case OpCode::NOT_EQUAL: {
+          return a != b;
+        }
+        case OpCode::GREATER: {
+          return a > b;
+        }
+        case OpCode::GREATER_EQUAL: {
+          return a >= b;
+        }
+        case OpCode::LESS: {
+          return a < b;
+        }
+        case OpCode::LESS_EQUAL: {
+          return a <= b;
+        }
+        case OpCode::ADD: {
+          return a + b;
+        }
+        case OpCode::SUB: {
+          return a - b;
+        }
+        case OpCode::MUL: {
+          return a * b;
+        }
+        case OpCode::DIV: {
+          return a / b;
+        }
+        case OpCode::MOD: {
+          return a % b;
+        }
+        case OpCode::EQUAL_NUM: {
+          return a.number_unchecked() == b.number_unchecked();
+        }
+        case OpCode::NOT_EQUAL_NUM: {
+          return a.number_unchecked() != b.number_unchecked();
+        }
+        case OpCode::GREATER_NUM: {
+          return a.number_unchecked() > b.number_unchecked();
+        }
+        case OpCode::GREATER_EQUAL_NUM: {
+          return a.number_unchecked() >= b.number_unchecked();
+        }
+        case OpCode::LESS_NUM: {
+          return a.number_unchecked() < b.number_unchecked();
+        }
+        case OpCode::LESS_EQUAL_NUM: {
+          return a.number_unchecked() <= b.number_unchecked();
+        }
+        case OpCode::ADD_NUM: {
+          return a.number_unchecked() + b.number_unchecked();
+        }
+        case OpCode::SUB_NUM: {
+          return a.number_unchecked() - b.number_unchecked();
+        }
+        case OpCode::MUL_NUM: {
+          return a.number_unchecked() * b.number_unchecked();
+        }
+        case OpCode::DIV_NUM: {
+          return a.number_unchecked() / b.number_unchecked();
+        }
+        case OpCode::MOD_NUM: {
+          return std::fmod(a.number_unchecked(), b.number_unchecked());
+        }
+        case OpCode::EQUAL_INT: {
+          return a.integer_unchecked() == b.integer_unchecked();
+        }
+        case OpCode::NOT_EQUAL_INT: {
+          return a.integer_unchecked() != b.integer_unchecked();
+        }
+        case OpCode::GREATER_INT: {
+          return a.integer_unchecked() > b.integer_unchecked();
+        }
+        case OpCode::GREATER_EQUAL_INT: {
+          return a.integer_unchecked() >= b.integer_unchecked();
+        }
+        case OpCode::LESS_INT: {
+          return a.integer_unchecked() < b.integer_unchecked();
+        }
+        case OpCode::LESS_EQUAL_INT: {
+          return a.integer_unchecked() <= b.integer_unchecked();
+        }
+        case OpCode::ADD_INT: {
+          return Value::wrapping_add(a.integer_unchecked(), b.integer_unchecked());
+        }
+        case OpCode::SUB_INT: {
+          return Value::wrapping_sub(a.integer_unchecked(), b.integer_unchecked());
+        }
+        case OpCode::MUL_INT: {
+          return Value::wrapping_mul(a.integer_unchecked(), b.integer_unchecked());
+        }
+        case OpCode::MOD_INT: {
+          return Value::remainder(a.integer_unchecked(), b.integer_unchecked());
+        }
+        case OpCode::BIT_AND: {
+          return a & b;
+        }
+        case OpCode::BIT_OR: {
+          return a | b;
+        }
+        case OpCode::BIT_XOR: {
+          return a ^ b;
+        }
+        case OpCode::SHIFT_LEFT: {
+          return a << b;
+        }
+        case OpCode::SHIFT_RIGHT: {
+          return a >> b;
+        }
+        default: {
+          RuntimeError::throw_err("invalid binary op code: ", op);
+        }
+      }
+      return Value();
+    }
+
+    auto operand_name(RegisterOperands::Source src) -> std::string
+    {
+      std::stringstream ss;
+      ss << (src.constant ? 'k' : 'r') << src.index;
+      return ss.str();
+    }
+  }  // namespace
+
   VM::VM(VMConfig cfg)
    : config(cfg)
+   , memory(new MemoryTracker(cfg.memory_limit()))
+   , collector(
+      cfg.gc_pause_budget(),
+      [this](const auto& visit) { this->chunk.visit_roots(visit); },
+      [this](const auto& visit) { this->chunk.visit_stack(visit); },
+      this->memory.get())
+   , chunk(this->memory.get())
+   , cache(cfg.compile_cache_size())
    , sp(0)
-  {}
+  {
+    for (auto& native : builtins::all()) {
+      this->set_var(native->name, Value(native));
+      this->builtin_globals.emplace(native->name);
+    }
+  }
 
-  void VM::set_var(Value::StringType name, Value value) noexcept
+  void VM::set_var(Value::StringType name, Value value)
   {
+    this->collector.write_barrier(value);
+    this->builtin_globals.erase(name);
     this->chunk.set_global(std::move(name), value);
   }
 
@@ -35,6 +187,41 @@ namespace ss
     return this->chunk.find_global(name)->second;
   }
 
+  void VM::collect_garbage()
+  {
+    this->collector.collect();
+  }
+
+  auto VM::gc_stats() const noexcept -> const Collector::Stats&
+  {
+    return this->collector.stats();
+  }
+
+  auto VM::memory_usage() const noexcept -> const MemoryTracker&
+  {
+    return *this->memory;
+  }
+
+  auto VM::compile_stats() const noexcept -> const CompileStats&
+  {
+    return this->last_compile_stats;
+  }
+
+  auto VM::compile_cache() const noexcept -> const CompileCache&
+  {
+    return this->cache;
+  }
+
+  auto VM::detach_debug_info() noexcept -> std::unique_ptr<BytecodeChunk::DebugInfo>
+  {
+    return this->chunk.detach_debug_info();
+  }
+
+  void VM::attach_debug_info(std::unique_ptr<BytecodeChunk::DebugInfo> info) noexcept
+  {
+    this->chunk.attach_debug_info(std::move(info));
+  }
+
   auto VM::repl(VMConfig cfg) -> int
   {
     VM vm(cfg);
@@ -66,17 +253,47 @@ namespace ss
 
   auto VM::run_file(std::string filename) -> Value
   {
+    if (bytecode::is_compiled_path(filename)) {
+      std::ifstream ifs(filename, std::ios::binary);
+      this->chunk.prepare();
+      this->load_bytecode(ifs);
+      this->ip = this->chunk.begin();
+      return this->execute();
+    }
+
     std::filesystem::path cwd = std::filesystem::current_path();
     std::stringstream ss;
     ss << cwd.string() << '/' << filename;
+    auto start = std::chrono::steady_clock::now();
     std::ifstream ifs(filename);
-    return this->run_script(util::stream_to_string(ifs), ss.str());
+    auto src = util::stream_to_string(ifs);
+    return this->run(ss.str(), std::move(src), std::chrono::steady_clock::now() - start);
   }
 
   auto VM::run_script(std::string src, std::filesystem::path path) -> Value
+  {
+    return this->run(path.string(), std::move(src), std::chrono::nanoseconds(0));
+  }
+
+  auto VM::run(std::string filename, std::string&& src, std::chrono::nanoseconds read) -> Value
   {
     this->chunk.prepare();
-    this->compile(path.string(), std::move(src));
+
+    if (this->cache.capacity() == 0) {
+      this->compile(std::move(filename), std::move(src), read);
+    } else if (auto program = this->cache.find(src, filename, this->chunk); program != nullptr) {
+      Collector::Scope gc_scope(this->collector);
+      MemoryTracker::Scope memory_scope(*this->memory);
+      this->chunk.load_program(*program);
+    } else {
+      std::string key = src;
+      this->compile(filename, std::move(src), read);
+
+      Collector::Scope gc_scope(this->collector);
+      this->cache.insert(
+       std::move(key), std::move(filename), this->chunk.save_program(), loaded_files(this->last_compile_stats));
+    }
+
     this->ip = this->chunk.begin();
     return this->execute();
   }
@@ -90,11 +307,85 @@ namespace ss
     this->execute();
   }
 
-  void VM::compile(std::string filename, std::string&& src)
+  void VM::compile(std::string filename, std::string&& src, std::chrono::nanoseconds read)
+  {
+    Compiler compiler(this->config.lazy_functions(), this->config.module_threads());
+    Collector::Scope gc_scope(this->collector);
+    MemoryTracker::Scope memory_scope(*this->memory);
+
+    std::size_t offset = this->chunk.instruction_count();
+
+    CompileStats* stats = nullptr;
+    // the cache needs to know what was loaded
+    if (this->config.compile_stats() || this->cache.capacity() > 0) {
+      this->last_compile_stats      = CompileStats{};
+      this->last_compile_stats.read = read;
+      stats                         = &this->last_compile_stats;
+    }
+
+    compiler.compile(std::move(src), this->chunk, filename, stats);
+
+    if (this->config.backend() == VMConfig::Backend::REGISTER) {
+      auto start = std::chrono::steady_clock::now();
+      RegisterTranslator translator(this->chunk);
+      translator.translate(offset);
+      if (stats != nullptr) {
+        stats->translate = std::chrono::steady_clock::now() - start;
+        stats->total += stats->translate;
+      }
+    }
+
+    this->chunk.shrink_to_fit();
+  }
+
+  void VM::load_bytecode(std::istream& in)
+  {
+    Collector::Scope gc_scope(this->collector);
+    MemoryTracker::Scope memory_scope(*this->memory);
+
+    std::size_t offset = this->chunk.instruction_count();
+
+    bytecode::read(in, this->chunk);
+
+    // written as a loaded file, so without the nil and END compiling a script finishes with
+    std::size_t count = this->chunk.instruction_count();
+    std::size_t line  = count == 0 ? 0 : this->chunk.line_at(count - 1);
+    this->chunk.write_constant(Value{}, line);
+    this->chunk.write(Instruction{OpCode::END}, line);
+
+    if (this->config.backend() == VMConfig::Backend::REGISTER) {
+      RegisterTranslator translator(this->chunk);
+      translator.translate(offset);
+    }
+
+    this->chunk.shrink_to_fit();
+  }
+
+  void VM::compile_function(Function& fn)
   {
-    Compiler compiler;
+    Compiler compiler(true);
+
+    // the code may move as it grows
+    std::size_t ip_offset = this->ip - this->chunk.begin();
+    std::size_t offset    = this->chunk.instruction_count();
+
+    compiler.compile_function(fn, this->chunk);
+
+    if (this->config.backend() == VMConfig::Backend::REGISTER) {
+      RegisterTranslator translator(this->chunk);
+      translator.translate(offset);
+    }
+
+    this->ip = this->chunk.begin() + ip_offset;
+  }
 
-    compiler.compile(std::move(src), this->chunk, filename);
+  auto VM::register_value(RegisterOperands::Source src) noexcept -> const Value&
+  {
+    if (src.constant) {
+      return this->chunk.constant_ref(src.index);
+    } else {
+      return this->chunk.index_stack_mut(this->sp + src.index);
+    }
   }
 
   auto VM::execute() -> Value
@@ -105,6 +396,24 @@ namespace ss
     if constexpr (PRINT_CONSTANTS) {
       this->chunk.print_constants(this->config);
     }
+
+    Collector::Scope gc_scope(this->collector);
+    MemoryTracker::Scope memory_scope(*this->memory);
+
+    try {
+      return this->dispatch();
+    } catch (RuntimeError& e) {
+      SourceLocation location = this->chunk.location_at(this->ip - this->chunk.begin());
+      if (location.line == 0) {
+        throw;
+      }
+      RuntimeError::throw_err(location.file, ':', location.line, " -> ", e.what());
+    }
+    return Value();
+  }
+
+  auto VM::dispatch() -> Value
+  {
     while (this->ip < this->chunk.end()) {
       if constexpr (DISASSEMBLE_INSTRUCTIONS) {
         if constexpr (PRINT_STACK) {
@@ -141,40 +450,48 @@ namespace ss
           this->chunk.index_stack_mut(this->sp + this->ip->modifying_bits) = this->chunk.peek_stack();
         } break;
         case OpCode::LOOKUP_GLOBAL: {
-          Value name_value = this->chunk.constant_at(this->ip->modifying_bits);
+          const Value& name_value = this->chunk.constant_ref(this->ip->modifying_bits);
           if (!name_value.is_type(Value::Type::String)) {
             RuntimeError::throw_err("invalid type for variable name");
           }
-          Value::StringType name = name_value.string();
-          auto var               = this->chunk.find_global(name);
+          auto name = name_value.string_view();
+          auto var  = this->chunk.find_global(name);
           if (!this->chunk.is_global_found(var)) {
             RuntimeError::throw_err("variable '", name, "' is undefined");
           }
           this->chunk.push_stack(var->second);
         } break;
         case OpCode::DEFINE_GLOBAL: {
-          Value name_value = this->chunk.constant_at(this->ip->modifying_bits);
+          const Value& name_value = this->chunk.constant_ref(this->ip->modifying_bits);
           if (!name_value.is_type(Value::Type::String)) {
             RuntimeError::throw_err("invalid type for variable name");
           }
-          Value::StringType name = name_value.string();
-          auto var               = this->chunk.find_global(name);
+          auto name = name_value.string_view();
+          auto var  = this->chunk.find_global(name);
           if (this->chunk.is_global_found(var)) {
-            RuntimeError::throw_err("variable '", name, "' is already defined");
+            // a builtin gives way to the script's own definition, once
+            auto builtin = this->builtin_globals.find(name);
+            if (builtin == this->builtin_globals.end()) {
+              RuntimeError::throw_err("variable '", name, "' is already defined");
+            }
+            this->builtin_globals.erase(builtin);
           }
-          this->chunk.set_global(std::move(name), this->chunk.pop_stack());
+          auto value = this->chunk.pop_stack();
+          this->collector.write_barrier(value);
+          this->chunk.set_global(Value::StringType(name), std::move(value));
         } break;
         case OpCode::ASSIGN_GLOBAL: {
-          Value name_value = this->chunk.constant_at(this->ip->modifying_bits);
+          const Value& name_value = this->chunk.constant_ref(this->ip->modifying_bits);
           if (!name_value.is_type(Value::Type::String)) {
             RuntimeError::throw_err("invalid type for variable name");
           }
-          Value::StringType name = name_value.string();
-          auto var               = this->chunk.find_global(std::move(name));
+          auto name = name_value.string_view();
+          auto var  = this->chunk.find_global(name);
           if (!this->chunk.is_global_found(var)) {
             RuntimeError::throw_err("variable '", name, "' is undefined");
           }
           var->second = this->chunk.peek_stack();
+          this->collector.write_barrier(var->second);
         } break;
         case OpCode::EQUAL: {
           Value b = this->chunk.pop_stack();
@@ -241,6 +558,171 @@ namespace ss
         case OpCode::NEGATE: {
           this->chunk.push_stack(-this->chunk.pop_stack());
         } break;
+        case OpCode::BIT_AND: {
+          Value b = this->chunk.pop_stack();
+          Value a = this->chunk.pop_stack();
+          this->chunk.push_stack(a & b);
+        } break;
+        case OpCode::BIT_OR: {
+          Value b = this->chunk.pop_stack();
+          Value a = this->chunk.pop_stack();
+          this->chunk.push_stack(a | b);
+        } break;
+        case OpCode::BIT_XOR: {
+          Value b = this->chunk.pop_stack();
+          Value a = this->chunk.pop_stack();
+          this->chunk.push_stack(a ^ b);
+        } break;
+        case OpCode::CONCAT_N: {
+          std::size_t count = this->ip->modifying_bits;
+          std::size_t first = this->chunk.stack_size() - count;
+          Value result      = Value::concat(std::span<const Value>(&this->chunk.index_stack_mut(first), count));
+          this->chunk.pop_stack_n(count);
+          this->chunk.push_stack(std::move(result));
+        } break;
+        case OpCode::BIT_NOT: {
+          this->chunk.push_stack(~this->chunk.pop_stack());
+        } break;
+        case OpCode::SHIFT_LEFT: {
+          Value b = this->chunk.pop_stack();
+          Value a = this->chunk.pop_stack();
+          this->chunk.push_stack(a << b);
+        } break;
+        case OpCode::SHIFT_RIGHT: {
+          Value b = this->chunk.pop_stack();
+          Value a = this->chunk.pop_stack();
+          this->chunk.push_stack(a >> b);
+        } break;
+        case OpCode::EQUAL_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() == b;
+        } break;
+        case OpCode::NOT_EQUAL_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() != b;
+        } break;
+        case OpCode::GREATER_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() > b;
+        } break;
+        case OpCode::GREATER_EQUAL_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() >= b;
+        } break;
+        case OpCode::LESS_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() < b;
+        } break;
+        case OpCode::LESS_EQUAL_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() <= b;
+        } break;
+        case OpCode::ADD_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() + b;
+        } break;
+        case OpCode::SUB_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() - b;
+        } break;
+        case OpCode::MUL_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() * b;
+        } break;
+        case OpCode::DIV_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.number_unchecked() / b;
+        } break;
+        case OpCode::MOD_NUM: {
+          auto b   = this->chunk.pop_stack().number_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = std::fmod(a.number_unchecked(), b);
+        } break;
+        case OpCode::NEGATE_NUM: {
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = -a.number_unchecked();
+        } break;
+        case OpCode::EQUAL_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.integer_unchecked() == b;
+        } break;
+        case OpCode::NOT_EQUAL_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.integer_unchecked() != b;
+        } break;
+        case OpCode::GREATER_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.integer_unchecked() > b;
+        } break;
+        case OpCode::GREATER_EQUAL_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.integer_unchecked() >= b;
+        } break;
+        case OpCode::LESS_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.integer_unchecked() < b;
+        } break;
+        case OpCode::LESS_EQUAL_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = a.integer_unchecked() <= b;
+        } break;
+        case OpCode::ADD_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = Value::wrapping_add(a.integer_unchecked(), b);
+        } break;
+        case OpCode::SUB_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = Value::wrapping_sub(a.integer_unchecked(), b);
+        } break;
+        case OpCode::MUL_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = Value::wrapping_mul(a.integer_unchecked(), b);
+        } break;
+        case OpCode::MOD_INT: {
+          auto b   = this->chunk.pop_stack().integer_unchecked();
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = Value::remainder(a.integer_unchecked(), b);
+        } break;
+        case OpCode::NEGATE_INT: {
+          Value& a = this->chunk.index_stack_mut(this->chunk.stack_size() - 1);
+          a        = Value::wrapping_neg(a.integer_unchecked());
+        } break;
+        case OpCode::BINARY_R: {
+          auto regs    = RegisterOperands::unpack(this->ip->modifying_bits);
+          Value result = binary_op(regs.op, this->register_value(regs.lhs), this->register_value(regs.rhs));
+          if (regs.dest == RegisterOperands::PUSH) {
+            this->chunk.push_stack(std::move(result));
+          } else {
+            this->chunk.index_stack_mut(this->sp + regs.dest) = std::move(result);
+          }
+          this->ip += RegisterTranslator::length_of(*this->ip);
+          continue;
+        } break;
+        case OpCode::MOVE_R: {
+          auto regs                                         = RegisterOperands::unpack(this->ip->modifying_bits);
+          this->chunk.index_stack_mut(this->sp + regs.dest) = this->register_value(regs.lhs);
+          this->ip += RegisterTranslator::length_of(*this->ip);
+          continue;
+        } break;
         case OpCode::PRINT: {
           config.write_line(this->chunk.pop_stack());
         } break;
@@ -266,6 +748,9 @@ namespace ss
           }
         } break;
         case OpCode::LOOP: {
+          if (this->collector.wants_step()) {
+            this->collector.step();
+          }
           this->ip -= this->ip->modifying_bits;
           continue;
         } break;
@@ -293,6 +778,10 @@ namespace ss
           this->sp = this->chunk.stack_size() - this->ip->modifying_bits - 1 - 1;
         } break;
         case OpCode::CALL: {
+          // safe point, everything the call needs is on the stack
+          if (this->collector.wants_step()) {
+            this->collector.step();
+          }
           auto fn_val = this->chunk.peek_stack(this->ip->modifying_bits + 2);
           switch (fn_val.type()) {
             case Value::Type::Function: {
@@ -304,6 +793,9 @@ namespace ss
                  ", got ",
                  this->ip->modifying_bits);
               }
+              if (!fn->is_compiled()) {
+                this->compile_function(*fn);
+              }
               this->ip = this->chunk.index_code_mut(fn->instruction_ptr);
             } break;
             case Value::Type::Native: {
@@ -316,10 +808,12 @@ namespace ss
                  this->ip->modifying_bits);
               }
               std::vector<Value> args;
-              // remove the stack pointer & return address
-              this->chunk.pop_stack_n(2);
-              // push arguments into vector
-              for (std::size_t i = 0; i < fn->airity; i++) { args.push_back(std::move(this->chunk.pop_stack())); }
+              // remove the return address & restore the stack pointer, natives have no frame of their own
+              this->chunk.pop_stack();
+              this->sp = this->chunk.pop_stack().address().ptr;
+              // move the arguments into the vector in call order, they sit on the stack with the last one on top
+              args.resize(fn->airity);
+              for (std::size_t i = fn->airity; i > 0; i--) { args[i - 1] = this->chunk.pop_stack(); }
               // remove the function
               this->chunk.pop_stack();
               this->chunk.push_stack(fn->call(std::move(args)));
@@ -386,10 +880,11 @@ namespace ss
     this->config.write("0x", std::hex, std::setw(4), std::setfill('0'), offset, ' ');
     this->config.reset_ostream();
 
-    if (offset > 0 && this->chunk.line_at(offset) == this->chunk.line_at(offset - 1)) {
+    std::size_t line = this->chunk.line_at(offset);
+    if (offset > 0 && line == this->chunk.line_at(offset - 1)) {
       this->config.write("   | ");
     } else {
-      this->config.write(std::setw(4), std::setfill('0'), this->chunk.line_at(offset), ' ');
+      this->config.write(std::setw(4), std::setfill('0'), line, ' ');
     }
 
     this->config.reset_ostream();
@@ -472,6 +967,59 @@ namespace ss
       SS_SIMPLE_PRINT_CASE(MOD)
       SS_SIMPLE_PRINT_CASE(NOT)
       SS_SIMPLE_PRINT_CASE(NEGATE)
+      SS_SIMPLE_PRINT_CASE(BIT_AND)
+      SS_SIMPLE_PRINT_CASE(BIT_OR)
+      SS_SIMPLE_PRINT_CASE(BIT_XOR)
+      SS_SIMPLE_PRINT_CASE(BIT_NOT)
+      SS_SIMPLE_PRINT_CASE(SHIFT_LEFT)
+      SS_SIMPLE_PRINT_CASE(SHIFT_RIGHT)
+      SS_COMPLEX_PRINT_CASE(CONCAT_N, {
+        this->config.write(std::setw(16), std::left, i.major_opcode);
+        this->config.reset_ostream();
+        this->config.write_line(' ', std::setw(4), i.modifying_bits);
+        this->config.reset_ostream();
+      })
+      SS_SIMPLE_PRINT_CASE(EQUAL_NUM)
+      SS_SIMPLE_PRINT_CASE(NOT_EQUAL_NUM)
+      SS_SIMPLE_PRINT_CASE(GREATER_NUM)
+      SS_SIMPLE_PRINT_CASE(GREATER_EQUAL_NUM)
+      SS_SIMPLE_PRINT_CASE(LESS_NUM)
+      SS_SIMPLE_PRINT_CASE(LESS_EQUAL_NUM)
+      SS_SIMPLE_PRINT_CASE(ADD_NUM)
+      SS_SIMPLE_PRINT_CASE(SUB_NUM)
+      SS_SIMPLE_PRINT_CASE(MUL_NUM)
+      SS_SIMPLE_PRINT_CASE(DIV_NUM)
+      SS_SIMPLE_PRINT_CASE(MOD_NUM)
+      SS_SIMPLE_PRINT_CASE(NEGATE_NUM)
+      SS_SIMPLE_PRINT_CASE(EQUAL_INT)
+      SS_SIMPLE_PRINT_CASE(NOT_EQUAL_INT)
+      SS_SIMPLE_PRINT_CASE(GREATER_INT)
+      SS_SIMPLE_PRINT_CASE(GREATER_EQUAL_INT)
+      SS_SIMPLE_PRINT_CASE(LESS_INT)
+      SS_SIMPLE_PRINT_CASE(LESS_EQUAL_INT)
+      SS_SIMPLE_PRINT_CASE(ADD_INT)
+      SS_SIMPLE_PRINT_CASE(SUB_INT)
+      SS_SIMPLE_PRINT_CASE(MUL_INT)
+      SS_SIMPLE_PRINT_CASE(MOD_INT)
+      SS_SIMPLE_PRINT_CASE(NEGATE_INT)
+      SS_COMPLEX_PRINT_CASE(BINARY_R, {
+        auto regs = RegisterOperands::unpack(i.modifying_bits);
+        this->config.write(std::setw(16), std::left, i.major_opcode);
+        this->config.reset_ostream();
+        this->config.write(' ', regs.op, ' ');
+        if (regs.dest == RegisterOperands::PUSH) {
+          this->config.write("push");
+        } else {
+          this->config.write('r', regs.dest);
+        }
+        this->config.write_line(", ", operand_name(regs.lhs), ", ", operand_name(regs.rhs));
+      })
+      SS_COMPLEX_PRINT_CASE(MOVE_R, {
+        auto regs = RegisterOperands::unpack(i.modifying_bits);
+        this->config.write(std::setw(16), std::left, i.major_opcode);
+        this->config.reset_ostream();
+        this->config.write_line(" r", regs.dest, ", ", operand_name(regs.lhs));
+      })
       SS_SIMPLE_PRINT_CASE(PRINT)
       SS_SIMPLE_PRINT_CASE(SWAP)
       SS_COMPLEX_PRINT_CASE(MOVE, {
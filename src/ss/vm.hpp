@@ -1,8 +1,10 @@
 #pragma once
 
+#include "cache.hpp"
 #include "cfg.hpp"
 #include "code.hpp"
 #include "datatypes.hpp"
+#include "gc.hpp"
 
 #include <cinttypes>
 #include <filesystem>
@@ -21,20 +23,79 @@ namespace ss
     auto run_file(std::string filename) -> Value;
     auto run_script(std::string src, std::filesystem::path path = std::filesystem::current_path()) -> Value;
 
-    void set_var(Value::StringType name, Value value) noexcept;
+    void set_var(Value::StringType name, Value value);
     auto get_var(Value::StringType name) noexcept -> Value;
 
+    /**
+     * @brief Runs a full garbage collection cycle, regardless of the pause budget
+     */
+    void collect_garbage();
+    auto gc_stats() const noexcept -> const Collector::Stats&;
+
+    /**
+     * @brief Bytes held by the VM, by category
+     */
+    auto memory_usage() const noexcept -> const MemoryTracker&;
+
+    /**
+     * @brief What the last compile spent its time on, only recorded when the config asks for it or for a compile cache
+     */
+    auto compile_stats() const noexcept -> const CompileStats&;
+
+    /**
+     * @brief Scripts compiled by run_script, kept to run again when the config asks for it
+     */
+    auto compile_cache() const noexcept -> const CompileCache&;
+
+    /**
+     * @brief Takes the line table and compile caches out of the loaded code. Runtime errors lose their location until it
+     * is attached again
+     */
+    auto detach_debug_info() noexcept -> std::unique_ptr<BytecodeChunk::DebugInfo>;
+    void attach_debug_info(std::unique_ptr<BytecodeChunk::DebugInfo> info) noexcept;
+
     void test();
 
    private:
     VMConfig config;
+    /**
+     * @brief Lives on after the VM until the strings charged to it that outlive the VM are gone
+     */
+    MemoryTracker::Owner memory;
+    /**
+     * @brief Declared before the chunk so the values in it are released before the collector goes away
+     */
+    Collector collector;
     BytecodeChunk chunk;
+    CompileCache cache;
     BytecodeChunk::InstructionIterator ip;
     std::size_t sp;
+    CompileStats last_compile_stats;
+    /**
+     * @brief Globals still holding the builtin they started with, a script may define its own in their place
+     */
+    BytecodeChunk::GlobalNameSet builtin_globals;
 
     void run_line(std::string line);
-    void compile(std::string filename, std::string&& src);
+    auto register_value(RegisterOperands::Source src) noexcept -> const Value&;
+    /**
+     * @param read Time it took to read the source, for the stats
+     */
+    auto run(std::string filename, std::string&& src, std::chrono::nanoseconds read) -> Value;
+    void compile(std::string filename, std::string&& src, std::chrono::nanoseconds read = {});
+    /**
+     * @brief Appends a compiled file to the code, ending it like a compiled script
+     */
+    void load_bytecode(std::istream& in);
+    /**
+     * @brief Compiles the body of a lazily compiled function onto the end of the code, keeping the instruction pointer
+     */
+    void compile_function(Function& fn);
+    /**
+     * @brief Runs from the current instruction, runtime errors are rethrown with the location they happened at
+     */
     auto execute() -> Value;
+    auto dispatch() -> Value;
 
     void disassemble_chunk() noexcept;
     void disassemble_instruction(Instruction i, std::size_t offset) noexcept;
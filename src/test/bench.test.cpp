@@ -0,0 +1,49 @@
+#include "bench/generate.hpp"
+#include "bench/measure.hpp"
+#include "ss/vm.hpp"
+
+#include "helpers.hpp"
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+using ss::VM;
+using ss::VMConfig;
+using ss::bench::Shape;
+
+TEST(Bench, METHOD(generate, makes_scripts_that_run))
+{
+  for (std::size_t i = 0; i < static_cast<std::size_t>(Shape::LAST); i++) {
+    auto shape = static_cast<Shape>(i);
+
+    std::ostringstream out;
+    VM vm(VMConfig(&std::cin, &out));
+    EXPECT_NO_THROW(vm.run_script(ss::bench::generate(shape, 20, 6))) << ss::bench::to_string(shape);
+
+    EXPECT_EQ(ss::bench::shape_from_string(ss::bench::to_string(shape)), shape);
+  }
+  EXPECT_EQ(ss::bench::shape_from_string("nested"), std::nullopt);
+}
+
+TEST(Bench, METHOD(generate, grows_with_the_size))
+{
+  for (std::size_t i = 0; i < static_cast<std::size_t>(Shape::LAST); i++) {
+    auto shape = static_cast<Shape>(i);
+    EXPECT_LT(ss::bench::generate(shape, 10, 4).size(), ss::bench::generate(shape, 20, 4).size());
+  }
+}
+
+TEST(Bench, METHOD(measure, reports_every_phase))
+{
+  auto phases = ss::bench::measure(ss::bench::generate(Shape::NESTED_FUNCTIONS, 10, 4), 2);
+
+  ASSERT_EQ(phases.size(), 4);
+  for (const auto& phase : phases) {
+    EXPECT_GT(phase.source_bytes, 0) << phase.phase;
+    EXPECT_EQ(phase.tokens, phases.front().tokens) << phase.phase;
+    EXPECT_GT(phase.peak_memory, 0) << phase.phase;
+  }
+  EXPECT_EQ(phases[1].instructions, phases[2].instructions);
+  // lazily compiled bodies are only stubs
+  EXPECT_LT(phases[3].instructions, phases[2].instructions);
+}
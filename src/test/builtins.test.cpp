@@ -0,0 +1,37 @@
+#include "helpers.hpp"
+#include "ss/builtins.hpp"
+#include "ss/exceptions.hpp"
+
+#include <gtest/gtest.h>
+
+using ss::RuntimeError;
+using ss::Value;
+namespace builtins = ss::builtins;
+
+TEST(Builtins, METHOD(substr, clamps_the_range_to_the_string))
+{
+  EXPECT_EQ(builtins::substr({Value("abcdef"), Value(Value::IntType{2}), Value(Value::IntType{3})}), Value("cde"));
+  EXPECT_EQ(builtins::substr({Value("abcdef"), Value(Value::IntType{4}), Value(Value::IntType{10})}), Value("ef"));
+  EXPECT_EQ(builtins::substr({Value("abcdef"), Value(Value::IntType{9}), Value(Value::IntType{1})}), Value(""));
+  EXPECT_THROW(builtins::substr({Value("abcdef"), Value(Value::IntType{-1}), Value(Value::IntType{1})}), RuntimeError);
+  EXPECT_THROW(builtins::substr({Value(1.0), Value(Value::IntType{0}), Value(Value::IntType{1})}), RuntimeError);
+}
+
+TEST(Builtins, METHOD(split, returns_the_requested_field))
+{
+  Value csv("a,,bc");
+  EXPECT_EQ(builtins::split({csv, Value(","), Value(Value::IntType{0})}), Value("a"));
+  EXPECT_EQ(builtins::split({csv, Value(","), Value(Value::IntType{1})}), Value(""));
+  EXPECT_EQ(builtins::split({csv, Value(","), Value(Value::IntType{2})}), Value("bc"));
+  EXPECT_EQ(builtins::split({csv, Value(","), Value(Value::IntType{3})}), Value());
+  EXPECT_THROW(builtins::split({csv, Value(""), Value(Value::IntType{0})}), RuntimeError);
+}
+
+TEST(Builtins, METHOD(trim, removes_surrounding_whitespace))
+{
+  Value padded(" \t x y \n");
+  auto trimmed = builtins::trim({padded});
+  EXPECT_EQ(trimmed, Value("x y"));
+  EXPECT_EQ(trimmed.string_view().data(), padded.string_view().data() + 3);
+  EXPECT_EQ(builtins::trim({Value("   ")}), Value(""));
+}
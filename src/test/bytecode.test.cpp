@@ -0,0 +1,183 @@
+#include "helpers.hpp"
+#include "ss/bytecode.hpp"
+#include "ss/exceptions.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using ss::BytecodeChunk;
+using ss::CompiletimeError;
+using ss::Compiler;
+using ss::Function;
+using ss::make_ref;
+using ss::Value;
+
+namespace bytecode = ss::bytecode;
+
+TEST(Bytecode, METHOD(read, gives_back_what_was_written))
+{
+  BytecodeChunk original;
+  Compiler compiler;
+  compiler.compile_module("let a = 1.5;\nlet b = 7;\nfn f(x) {\n  ret x + \"s\";\n}\nprint f(a) + f(b);\n", original, "f.ss");
+
+  std::stringstream file;
+  bytecode::write(original, file);
+
+  BytecodeChunk chunk;
+  bytecode::read(file, chunk);
+
+  ASSERT_EQ(chunk.instruction_count(), original.instruction_count());
+  ASSERT_EQ(chunk.constant_count(), original.constant_count());
+  for (std::size_t i = 0; i < chunk.instruction_count(); i++) {
+    EXPECT_EQ(chunk.index_code_mut(i)->major_opcode, original.index_code_mut(i)->major_opcode);
+    EXPECT_EQ(chunk.index_code_mut(i)->modifying_bits, original.index_code_mut(i)->modifying_bits);
+    EXPECT_EQ(chunk.location_at(i).line, original.location_at(i).line);
+  }
+  for (std::size_t i = 0; i < chunk.constant_count(); i++) {
+    const Value& constant = chunk.constant_ref(i);
+    ASSERT_EQ(constant.type(), original.constant_ref(i).type());
+    if (constant.is_type(Value::Type::Function)) {
+      EXPECT_EQ(constant.function()->name, original.constant_ref(i).function()->name);
+      EXPECT_EQ(constant.function()->instruction_ptr, original.constant_ref(i).function()->instruction_ptr);
+    } else {
+      EXPECT_EQ(constant, original.constant_ref(i));
+    }
+  }
+
+  EXPECT_EQ(chunk.find_ident("a"), original.find_ident("a"));
+  EXPECT_TRUE(chunk.is_global_defined("b"));
+  EXPECT_EQ(std::string(chunk.location_at(0).file), "f.ss");
+}
+
+TEST(Bytecode, METHOD(read, keeps_lazy_functions_uncompiled))
+{
+  BytecodeChunk original;
+  Compiler compiler(true);
+  compiler.compile_module("fn f(x) {\n  ret x;\n}\n", original, "lazy.ss");
+
+  std::stringstream file;
+  bytecode::write(original, file);
+
+  BytecodeChunk chunk;
+  bytecode::read(file, chunk);
+
+  bool found = false;
+  for (std::size_t i = 0; i < chunk.constant_count(); i++) {
+    if (chunk.constant_ref(i).is_type(Value::Type::Function)) {
+      auto fn = chunk.constant_ref(i).function();
+      EXPECT_FALSE(fn->is_compiled());
+      EXPECT_EQ(fn->source->file, "lazy.ss");
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+TEST(Bytecode, METHOD(read, rejects_other_files))
+{
+  BytecodeChunk chunk;
+
+  std::stringstream garbage("print 1;");
+  EXPECT_THROW(bytecode::read(garbage, chunk), CompiletimeError);
+
+  BytecodeChunk original;
+  Compiler compiler;
+  compiler.compile_module("print 1;\n", original, "a.ss");
+  std::stringstream file;
+  bytecode::write(original, file);
+
+  auto data = file.str();
+  std::stringstream wrong_version(data.substr(0, 4) + '\x7f' + data.substr(5));
+  EXPECT_THROW(bytecode::read(wrong_version, chunk), CompiletimeError);
+
+  std::stringstream cut_short(data.substr(0, data.size() / 2));
+  EXPECT_THROW(bytecode::read(cut_short, chunk), CompiletimeError);
+}
+
+TEST(Bytecode, METHOD(read, rejects_code_that_leaves_the_file))
+{
+  auto read_program = [](BytecodeChunk::Program program) {
+    BytecodeChunk original;
+    original.load_program(program);
+    std::stringstream file;
+    bytecode::write(original, file);
+
+    BytecodeChunk chunk;
+    bytecode::read(file, chunk);
+  };
+
+  BytecodeChunk::Program program;
+  program.code = {
+    ss::Instruction{ss::OpCode::NO_OP},
+    ss::Instruction{ss::OpCode::LOOP, 1},
+    ss::Instruction{ss::OpCode::JUMP, 1},
+  };
+  EXPECT_NO_THROW(read_program(program));
+
+  auto far_loop                   = program;
+  far_loop.code[1].modifying_bits = std::size_t{1} << 40;
+  EXPECT_THROW(read_program(far_loop), CompiletimeError);
+
+  auto far_jump                   = program;
+  far_jump.code[2].modifying_bits = 2;
+  EXPECT_THROW(read_program(far_jump), CompiletimeError);
+
+  auto far_function = program;
+  far_function.constants.emplace_back(make_ref<Function>("f", 0, 0x7fffffff));
+  EXPECT_THROW(read_program(far_function), CompiletimeError);
+
+  auto far_address = program;
+  far_address.constants.emplace_back(Value::AddressType{4});
+  EXPECT_THROW(read_program(far_address), CompiletimeError);
+}
+
+TEST(Bytecode, METHOD(has_fresh, requires_the_compiled_file_to_be_no_older_than_the_source))
+{
+  auto dir = std::filesystem::temp_directory_path() / "ss_bytecode_fresh";
+  std::filesystem::create_directories(dir);
+  auto source = (dir / "a.ss").string();
+  std::ofstream(source) << "print 1;\n";
+
+  EXPECT_EQ(bytecode::compiled_path(source), (dir / "a.ssc").string());
+  EXPECT_FALSE(bytecode::has_fresh(source));
+
+  bytecode::compile_file(source, bytecode::compiled_path(source));
+  EXPECT_TRUE(bytecode::has_fresh(source));
+
+  auto compiled_time = std::filesystem::last_write_time(bytecode::compiled_path(source));
+  std::filesystem::last_write_time(source, compiled_time + std::chrono::seconds(1));
+  EXPECT_FALSE(bytecode::has_fresh(source));
+
+  std::filesystem::remove(source);
+  EXPECT_TRUE(bytecode::has_fresh(source));
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST(Bytecode, METHOD(has_fresh, requires_every_file_linked_in_to_be_unchanged))
+{
+  auto dir = std::filesystem::temp_directory_path() / "ss_bytecode_dependencies";
+  std::filesystem::create_directories(dir);
+  auto write = [&dir](const char* name, const char* src) { std::ofstream(dir / name) << src; };
+  auto path  = [&dir](const char* name) { return std::filesystem::absolute(dir / name).string(); };
+
+  write("a.ss", "loadr \"b.ss\";\n");
+  write("b.ss", "loadr \"c.ss\";\n");
+  write("c.ss", "print 1;\n");
+
+  // a reads b as bytecode, what b links in still counts
+  bytecode::compile_file(path("b.ss"), bytecode::compiled_path(path("b.ss")));
+  bytecode::compile_file(path("a.ss"), bytecode::compiled_path(path("a.ss")));
+  EXPECT_EQ(bytecode::dependencies(path("a.ss")), (std::vector<std::string>{path("b.ss"), path("b.ssc"), path("c.ss")}));
+  EXPECT_TRUE(bytecode::has_fresh(path("a.ss")));
+
+  auto c_time = std::filesystem::last_write_time(path("c.ss"));
+  std::filesystem::last_write_time(path("c.ss"), c_time + std::chrono::seconds(1));
+  EXPECT_FALSE(bytecode::has_fresh(path("a.ss")));
+  EXPECT_FALSE(bytecode::has_fresh(path("b.ss")));
+
+  std::filesystem::remove_all(dir);
+}
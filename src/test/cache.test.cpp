@@ -0,0 +1,76 @@
+#include "helpers.hpp"
+#include "ss/cache.hpp"
+
+#include <gtest/gtest.h>
+
+using ss::BytecodeChunk;
+using ss::CompileCache;
+
+namespace
+{
+  auto program_of(std::size_t instructions) -> BytecodeChunk::Program
+  {
+    BytecodeChunk::Program program;
+    program.code.resize(instructions);
+    return program;
+  }
+}  // namespace
+
+TEST(CompileCache, METHOD(find, returns_the_program_for_the_same_source_and_path))
+{
+  BytecodeChunk chunk;
+  CompileCache cache(4);
+
+  cache.insert("print 1;", "a.ss", program_of(3));
+
+  auto program = cache.find("print 1;", "a.ss", chunk);
+  ASSERT_NE(program, nullptr);
+  EXPECT_EQ(program->code.size(), 3);
+
+  EXPECT_EQ(cache.find("print 1;", "b.ss", chunk), nullptr);
+  EXPECT_EQ(cache.find("print 2;", "a.ss", chunk), nullptr);
+
+  EXPECT_EQ(cache.stats().hits, 1);
+  EXPECT_EQ(cache.stats().misses, 2);
+}
+
+TEST(CompileCache, METHOD(insert, evicts_the_least_recently_used))
+{
+  BytecodeChunk chunk;
+  CompileCache cache(2);
+
+  cache.insert("a", "", program_of(1));
+  cache.insert("b", "", program_of(2));
+  ASSERT_NE(cache.find("a", "", chunk), nullptr);
+
+  cache.insert("c", "", program_of(3));
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.stats().evictions, 1);
+  EXPECT_NE(cache.find("a", "", chunk), nullptr);
+  EXPECT_EQ(cache.find("b", "", chunk), nullptr);
+  EXPECT_NE(cache.find("c", "", chunk), nullptr);
+}
+
+TEST(CompileCache, METHOD(insert, keeps_nothing_without_capacity))
+{
+  BytecodeChunk chunk;
+  CompileCache cache(0);
+
+  cache.insert("a", "", program_of(1));
+
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.find("a", "", chunk), nullptr);
+}
+
+TEST(CompileCache, METHOD(find, drops_programs_compiled_before_more_globals_were_assigned))
+{
+  BytecodeChunk chunk;
+  CompileCache cache(4);
+
+  cache.insert("a", "", chunk.save_program());
+  chunk.mark_global_assigned("x");
+
+  EXPECT_EQ(cache.find("a", "", chunk), nullptr);
+  EXPECT_EQ(cache.size(), 0);
+}
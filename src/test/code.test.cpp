@@ -41,6 +41,66 @@ TEST_F(TestBytecodeChunk, METHOD(write_constant, can_write_constant))
   EXPECT_EQ(this->chunk.constant_at(2), Value("str"));
 }
 
+TEST_F(TestBytecodeChunk, METHOD(line_at, finds_the_line_of_every_instruction))
+{
+  for (std::size_t line = 1; line <= 100; line++) {
+    for (std::size_t i = 0; i < line % 3 + 1; i++) { this->chunk.write(Instruction{OpCode::NO_OP}, line * 10); }
+  }
+
+  std::size_t offset = 0;
+  for (std::size_t line = 1; line <= 100; line++) {
+    for (std::size_t i = 0; i < line % 3 + 1; i++) { EXPECT_EQ(this->chunk.line_at(offset++), line * 10); }
+  }
+}
+
+TEST_F(TestBytecodeChunk, METHOD(location_at, tracks_the_file_and_column_of_each_run))
+{
+  std::size_t main   = this->chunk.add_file("main.ss");
+  std::size_t module = this->chunk.add_file("module.ss");
+
+  EXPECT_EQ(this->chunk.add_file("main.ss"), main);
+
+  this->chunk.write(Instruction{OpCode::NO_OP}, 1, 5, main);
+  this->chunk.write(Instruction{OpCode::NO_OP}, 1, 9, main);
+  this->chunk.write(Instruction{OpCode::NO_OP}, 1, 3, module);
+  this->chunk.write(Instruction{OpCode::NO_OP}, 2, 7, main);
+
+  auto first = this->chunk.location_at(1);
+  EXPECT_EQ(first.file, "main.ss");
+  EXPECT_EQ(first.line, 1);
+  EXPECT_EQ(first.column, 5);
+
+  auto loaded = this->chunk.location_at(2);
+  EXPECT_EQ(loaded.file, "module.ss");
+  EXPECT_EQ(loaded.line, 1);
+  EXPECT_EQ(loaded.column, 3);
+
+  auto last = this->chunk.location_at(3);
+  EXPECT_EQ(last.file, "main.ss");
+  EXPECT_EQ(last.line, 2);
+  EXPECT_EQ(last.column, 7);
+}
+
+TEST_F(TestBytecodeChunk, METHOD(detach_debug_info, leaves_the_code_runnable_without_locations))
+{
+  EXPECT_FALSE(this->chunk.has_debug_info());
+
+  this->chunk.write_constant(Value(1.0), 3, 1, this->chunk.add_file("main.ss"));
+  auto ident = this->chunk.add_ident("name");
+
+  auto info = this->chunk.detach_debug_info();
+  ASSERT_NE(info, nullptr);
+  EXPECT_FALSE(this->chunk.has_debug_info());
+  EXPECT_EQ(this->chunk.line_at(0), 0);
+  EXPECT_FALSE(this->chunk.find_ident("name").has_value());
+  EXPECT_EQ(this->chunk.constant_at(0), Value(1.0));
+
+  this->chunk.attach_debug_info(std::move(info));
+  EXPECT_EQ(this->chunk.location_at(0).file, "main.ss");
+  EXPECT_EQ(this->chunk.line_at(0), 3);
+  EXPECT_EQ(this->chunk.find_ident("name"), ident);
+}
+
 TEST_F(TestBytecodeChunk, METHOD(push_stack__pop_stack, can_push_onto_stack_and_pop))
 {
   EXPECT_TRUE(this->chunk.stack_empty());
@@ -58,6 +118,60 @@ TEST_F(TestBytecodeChunk, METHOD(push_stack__pop_stack, can_push_onto_stack_and_
   EXPECT_TRUE(this->chunk.stack_empty());
 }
 
+TEST_F(TestBytecodeChunk, METHOD(intern, returns_the_same_object_for_equal_strings))
+{
+  Value a = this->chunk.intern("str");
+  Value b = this->chunk.intern(std::string("st") + "r");
+  Value c = this->chunk.intern("other");
+
+  EXPECT_EQ(a.string_view().data(), b.string_view().data());
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(a, Value("str"));
+}
+
+TEST_F(TestBytecodeChunk, METHOD(prepare, drops_interned_strings_nothing_refers_to))
+{
+  Value kept = this->chunk.intern("kept");
+  std::weak_ptr<ss::String> dropped = this->chunk.intern("dropped").string_object();
+  this->chunk.write_constant(this->chunk.intern("constant"), 1);
+
+  EXPECT_FALSE(dropped.expired());
+
+  this->chunk.prepare();
+
+  EXPECT_TRUE(dropped.expired());
+  EXPECT_EQ(this->chunk.intern("kept").string_view().data(), kept.string_view().data());
+}
+
+TEST_F(TestBytecodeChunk, METHOD(link, relocates_what_the_module_refers_to))
+{
+  this->chunk.write_constant(Value(1.0), 1);
+  Value name = this->chunk.intern("name");
+
+  BytecodeChunk module;
+  std::size_t file = module.add_file("module.ss");
+  module.write_constant(Value(ss::make_ref<ss::Function>("fn", 0, 1)), 1, 1, file);
+  module.write(Instruction{OpCode::LOOKUP_GLOBAL, module.add_ident("name")}, 2, 1, file);
+  module.write_constant(Value{Value::AddressType{1}}, 3, 1, file);
+  module.mark_global_assigned("name");
+
+  this->chunk.link(std::move(module));
+
+  ASSERT_EQ(this->chunk.instruction_count(), 4);
+  EXPECT_EQ(this->chunk.index_code_mut(1)->modifying_bits, 1);
+  EXPECT_EQ(this->chunk.constant_at(1).function()->instruction_ptr, 2);
+  EXPECT_EQ(this->chunk.index_code_mut(2)->major_opcode, OpCode::LOOKUP_GLOBAL);
+  EXPECT_EQ(this->chunk.index_code_mut(2)->modifying_bits, 2);
+  EXPECT_EQ(this->chunk.constant_at(2).string_view().data(), name.string_view().data());
+  EXPECT_EQ(this->chunk.find_ident("name"), 2);
+  EXPECT_EQ(this->chunk.constant_at(3).address().ptr, 2);
+  EXPECT_EQ(this->chunk.location_at(3).file, "module.ss");
+  EXPECT_EQ(this->chunk.location_at(3).line, 3);
+  EXPECT_TRUE(this->chunk.is_global_assigned("name"));
+  EXPECT_EQ(module.instruction_count(), 0);
+}
+
 TEST_F(TestBytecodeChunk, METHOD(pop_stack_n, removes_the_specified_range))
 {
   for (int i = 0; i < 10; i++) { this->chunk.push_stack(Value(1.0 * i)); }
@@ -168,6 +282,120 @@ TEST(Scanner, METHOD(scan, some_code))
   for (std::size_t i = 0; i < expected.size(); i++) { EXPECT_EQ(expected[i], tokens[i]) << "i: " << i; }
 }
 
+TEST(Scanner, METHOD(scan, parses_number_literals))
+{
+  std::string text = "42 1_000_000 2.5 0x1F 0b1010 0xFFFF_FFFF_FFFF_FFFF 99999999999999999999 1_0.2_5";
+
+  Scanner scanner(std::move(text));
+
+  auto tokens = scanner.scan();
+
+  std::vector<Value> expected = {
+   Value(Value::IntType{42}),
+   Value(Value::IntType{1000000}),
+   Value(2.5),
+   Value(Value::IntType{31}),
+   Value(Value::IntType{10}),
+   Value(Value::IntType{-1}),
+   Value(1e20),
+   Value(10.25),
+  };
+
+  ASSERT_EQ(tokens.size(), expected.size() + 1);
+
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(tokens[i].type, Token::Type::NUMBER) << "i: " << i;
+    EXPECT_EQ(tokens[i].value.type(), expected[i].type()) << "i: " << i;
+    EXPECT_EQ(tokens[i].value, expected[i]) << "i: " << i;
+  }
+}
+
+TEST(Scanner, METHOD(scan, counts_the_lines_comments_end_on))
+{
+  std::string text = "# a comment\n  let a = \"two\nlines\";\n\n# another\nprint a;";
+
+  Scanner scanner(std::move(text));
+
+  auto tokens = scanner.scan();
+
+  ASSERT_EQ(tokens.size(), 9);
+  EXPECT_EQ(tokens[0].lexeme, "let");
+  EXPECT_EQ(tokens[0].line, 2);
+  EXPECT_EQ(tokens[0].column, 4);
+  EXPECT_EQ(tokens[3].lexeme, "two\nlines");
+  EXPECT_EQ(tokens[5].lexeme, "print");
+  EXPECT_EQ(tokens[5].line, 6);
+}
+
+TEST(Scanner, METHOD(scan, recognizes_keywords_and_nothing_close_to_them))
+{
+  std::string text =
+   "and break class cont else end false for fn if let load loadr loop match nil or print ret true while "
+   "an breaks klass continue loads lo f o whilst _if fn2 Nil";
+
+  Scanner scanner(std::move(text));
+
+  auto tokens = scanner.scan();
+
+  std::vector<Token::Type> expected = {
+   Token::Type::AND,    Token::Type::BREAK, Token::Type::CLASS, Token::Type::CONTINUE, Token::Type::ELSE,
+   Token::Type::END,    Token::Type::FALSE, Token::Type::FOR,   Token::Type::FN,       Token::Type::IF,
+   Token::Type::LET,    Token::Type::LOAD,  Token::Type::LOADR, Token::Type::LOOP,     Token::Type::MATCH,
+   Token::Type::NIL,    Token::Type::OR,    Token::Type::PRINT, Token::Type::RETURN,   Token::Type::TRUE,
+   Token::Type::WHILE,
+  };
+  expected.resize(expected.size() + 12, Token::Type::IDENTIFIER);
+
+  ASSERT_EQ(tokens.size(), expected.size() + 1);
+  for (std::size_t i = 0; i < expected.size(); i++) { EXPECT_EQ(tokens[i].type, expected[i]) << tokens[i].lexeme; }
+}
+
+TEST(Scanner, METHOD(scan, rejects_oversized_hex_literals))
+{
+  std::string text = "0x1_0000_0000_0000_0000";
+
+  Scanner scanner(std::move(text));
+
+  EXPECT_THROW(scanner.scan(), ss::CompiletimeError);
+}
+
+TEST(Scanner, METHOD(scan, allocates_tokens_from_the_given_resource))
+{
+  std::string text = "let a = 1;";
+  ss::util::Arena arena;
+
+  Scanner scanner(std::move(text), &arena);
+
+  auto tokens = scanner.scan();
+
+  EXPECT_EQ(tokens.get_allocator().resource(), &arena);
+  EXPECT_GT(arena.allocated(), 0);
+}
+
+TEST(TokenStream, METHOD(peek, pulls_the_same_tokens_scan_produces))
+{
+  std::string text = "let a = 1; while a < 10 { a = a + 1; } print a;";
+  std::string copy = text;
+
+  Scanner batch(std::move(copy));
+  auto expected = batch.scan();
+
+  Scanner scanner(std::move(text));
+  ss::TokenStream stream(scanner);
+
+  // far enough ahead that the buffer has to grow
+  EXPECT_EQ(stream.peek(expected.size() - 1).type, Token::Type::END_OF_FILE);
+
+  for (const auto& token : expected) {
+    EXPECT_EQ(stream.peek().type, token.type);
+    EXPECT_EQ(stream.peek().lexeme, token.lexeme);
+    stream.advance();
+    EXPECT_EQ(stream.previous().lexeme, token.lexeme);
+  }
+
+  EXPECT_EQ(stream.peek().type, Token::Type::END_OF_FILE);
+}
+
 using ss::Instruction;
 using ss::Local;
 using ss::OpCode;
@@ -205,3 +433,203 @@ TEST(Parser, METHOD(parse, some_math))
 
   ASSERT_EQ(expected.size(), chunk.instruction_count());
 }
+
+namespace
+{
+  auto count_global_lookups_after(BytecodeChunk& chunk, OpCode marker) -> std::size_t
+  {
+    auto it = chunk.begin();
+    while (it < chunk.end() && it->major_opcode != marker) { it++; }
+
+    std::size_t count = 0;
+    for (; it < chunk.end(); it++) {
+      if (it->major_opcode == OpCode::LOOKUP_GLOBAL) {
+        count++;
+      }
+    }
+    return count;
+  }
+}  // namespace
+
+TEST(Parser, METHOD(parse, hoists_loop_invariant_globals))
+{
+  std::string src = "let n = 3; let i = 0; while i < n { i = i + n; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  // only 'i' is looked up within the loop body
+  EXPECT_EQ(count_global_lookups_after(chunk, OpCode::JUMP_IF_FALSE), 1);
+}
+
+TEST(Parser, METHOD(parse, hoists_loop_invariant_globals_when_pulling_tokens))
+{
+  std::string src = "let n = 3; let i = 0; while i < n { i = i + n; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner, chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  EXPECT_EQ(count_global_lookups_after(chunk, OpCode::JUMP_IF_FALSE), 1);
+}
+
+TEST(Parser, METHOD(parse, does_not_hoist_assigned_globals))
+{
+  std::string src = "let n = 3; n = 2; let i = 0; while i < n { i = i + n; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  EXPECT_EQ(count_global_lookups_after(chunk, OpCode::JUMP_IF_FALSE), 2);
+}
+
+namespace
+{
+  auto count_opcode(BytecodeChunk& chunk, OpCode op) -> std::size_t
+  {
+    std::size_t count = 0;
+    for (const auto& i : chunk) {
+      if (i.major_opcode == op) {
+        count++;
+      }
+    }
+    return count;
+  }
+}  // namespace
+
+TEST(Parser, METHOD(parse, emits_typed_ops_for_proven_numbers))
+{
+  std::string src = "{ let a = 1.0; let b = a * 2.0; print a + b; print -b < 3.0; print a + \"s\"; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  EXPECT_EQ(count_opcode(chunk, OpCode::MUL_NUM), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD_NUM), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::NEGATE_NUM), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::LESS_NUM), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::CONCAT_N), 1);
+}
+
+TEST(Parser, METHOD(parse, emits_integer_ops_for_proven_integers))
+{
+  std::string src = "{ let a = 1; let b = a * 2; print a + b; print -b < 3; print a / b; print a + 1.5; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  EXPECT_EQ(count_opcode(chunk, OpCode::MUL_INT), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD_INT), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::NEGATE_INT), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::LESS_INT), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::DIV), 1);
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD), 1);
+}
+
+TEST(Parser, METHOD(parse, joins_string_chains_with_one_instruction))
+{
+  std::string src = "{ let a = 1; print a + \":\" + a + \":\" + a; print a + a + \"s\"; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  std::vector<std::size_t> counts;
+  for (const auto& i : chunk) {
+    if (i.major_opcode == OpCode::CONCAT_N) {
+      counts.push_back(i.modifying_bits);
+    }
+  }
+
+  EXPECT_EQ(counts, (std::vector<std::size_t>{5, 2}));
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD_INT), 1);
+}
+
+TEST(Parser, METHOD(parse, reverts_typed_ops_when_a_loop_changes_a_type))
+{
+  std::string src = "{ let a = 1; while a < 3 { print a + 1; a = \"s\"; } print a + 1; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  EXPECT_EQ(count_opcode(chunk, OpCode::LESS_INT), 0);
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD_INT), 0);
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD), 2);
+}
+
+TEST(Parser, METHOD(parse, forgets_types_a_loop_gives_when_it_may_not_run))
+{
+  std::string src = "{ let a = nil; while false { a = 1; } print a + 1; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD_INT), 0);
+  EXPECT_EQ(count_opcode(chunk, OpCode::ADD), 1);
+}
+
+using ss::RegisterOperands;
+using ss::RegisterTranslator;
+
+TEST(RegisterTranslator, METHOD(translate, fuses_local_operations))
+{
+  std::string src = "{ let a = 1; let b = 0; let c = 0; b = a; c = a + b; print a * 2; }";
+  Scanner scanner(std::move(src));
+
+  BytecodeChunk chunk;
+
+  Parser parser(scanner.scan(), chunk, "TEST");
+
+  EXPECT_NO_THROW(parser.parse());
+
+  RegisterTranslator translator(chunk);
+  translator.translate(0);
+
+  EXPECT_EQ(count_opcode(chunk, OpCode::MOVE_R), 1);
+  ASSERT_EQ(count_opcode(chunk, OpCode::BINARY_R), 2);
+
+  for (const auto& i : chunk) {
+    if (i.major_opcode == OpCode::BINARY_R) {
+      auto regs = RegisterOperands::unpack(i.modifying_bits);
+      if (regs.op == OpCode::ADD_INT) {
+        EXPECT_EQ(regs.dest, 2);
+        EXPECT_FALSE(regs.lhs.constant);
+        EXPECT_EQ(regs.rhs.index, 1);
+      } else {
+        EXPECT_EQ(regs.op, OpCode::MUL_INT);
+        EXPECT_EQ(regs.dest, RegisterOperands::PUSH);
+        EXPECT_TRUE(regs.rhs.constant);
+      }
+    }
+  }
+}
@@ -4,6 +4,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+
 using ss::RuntimeError;
 using ss::Value;
 
@@ -307,3 +310,212 @@ TEST(Value, METHOD(assign_operator, can_assign))
   x = Value::nil;
   EXPECT_EQ(x, nil);
 }
+
+TEST(Value, METHOD(operator_less_equal, includes_equal_values))
+{
+  EXPECT_TRUE(Value(1.0) <= Value(1.0));
+  EXPECT_TRUE(Value(1.0) <= Value(2.0));
+  EXPECT_FALSE(Value(2.0) <= Value(1.0));
+}
+
+TEST(Value, METHOD(operator_add, keeps_integers_exact))
+{
+  Value a(Value::IntType{9007199254740993});
+  Value b(Value::IntType{2});
+  EXPECT_EQ(a + b, Value(Value::IntType{9007199254740995}));
+  EXPECT_TRUE((a + b).is_type(Value::Type::Int));
+}
+
+TEST(Value, METHOD(operator_add, wraps_integers_on_overflow))
+{
+  Value a(std::numeric_limits<Value::IntType>::max());
+  Value b(Value::IntType{1});
+  EXPECT_EQ(a + b, Value(std::numeric_limits<Value::IntType>::min()));
+}
+
+TEST(Value, METHOD(operator_add, promotes_mixed_integers_and_numbers))
+{
+  Value a(Value::IntType{1});
+  Value b(0.5);
+  EXPECT_EQ(a + b, Value(1.5));
+  EXPECT_EQ(b + a, Value(1.5));
+}
+
+TEST(Value, METHOD(operator_div, keeps_exact_integer_quotients))
+{
+  Value a(Value::IntType{6});
+  Value b(Value::IntType{3});
+  Value c(Value::IntType{4});
+  EXPECT_TRUE((a / b).is_type(Value::Type::Int));
+  EXPECT_EQ(a / b, Value(Value::IntType{2}));
+  EXPECT_EQ(a / c, Value(1.5));
+}
+
+TEST(Value, METHOD(operator_mod, can_mod_integers))
+{
+  Value a(Value::IntType{-7});
+  Value b(Value::IntType{3});
+  EXPECT_EQ(a % b, Value(Value::IntType{-1}));
+}
+
+TEST(Value, METHOD(operator_div, divides_by_zero_like_numbers_for_every_type))
+{
+  Value int_one(Value::IntType{1});
+  Value int_zero(Value::IntType{0});
+
+  EXPECT_EQ(int_one / int_zero, Value(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ(Value(1.0) / Value(0.0), Value(std::numeric_limits<double>::infinity()));
+  EXPECT_TRUE(std::isnan((int_one % int_zero).number()));
+  EXPECT_TRUE(std::isnan((Value(1.0) % Value(0.0)).number()));
+  EXPECT_TRUE(std::isnan((int_one % Value(0.0)).number()));
+}
+
+TEST(Value, METHOD(operator_equal, compares_integers_and_numbers_by_value))
+{
+  EXPECT_EQ(Value(Value::IntType{1}), Value(1.0));
+  EXPECT_NE(Value(Value::IntType{1}), Value(1.5));
+  EXPECT_TRUE(Value(Value::IntType{1}) < Value(1.5));
+  EXPECT_FALSE(Value(Value::IntType{2}) <= Value(1.5));
+}
+
+TEST(Value, METHOD(operator_equal, compares_integers_and_numbers_exactly))
+{
+  // 2^53 + 1 has no double, it rounds to 2^53
+  Value big(Value::IntType{9007199254740993});
+  EXPECT_NE(big, Value(9007199254740992.0));
+  EXPECT_TRUE(big > Value(9007199254740992.0));
+  EXPECT_TRUE(Value(9007199254740992.0) < big);
+
+  Value max(std::numeric_limits<Value::IntType>::max());
+  EXPECT_TRUE(max < Value(9223372036854775808.0));
+  EXPECT_TRUE(Value(Value::IntType{-3}) < Value(-2.5));
+  EXPECT_FALSE(Value(Value::IntType{0}) == Value(std::numeric_limits<double>::quiet_NaN()));
+}
+
+TEST(Value, METHOD(bitwise_operators, operate_on_integers))
+{
+  Value a(Value::IntType{0b1100});
+  Value b(Value::IntType{0b1010});
+  EXPECT_EQ(a & b, Value(Value::IntType{0b1000}));
+  EXPECT_EQ(a | b, Value(Value::IntType{0b1110}));
+  EXPECT_EQ(a ^ b, Value(Value::IntType{0b0110}));
+  EXPECT_EQ(~a, Value(Value::IntType{~0b1100}));
+  EXPECT_EQ(a << Value(Value::IntType{2}), Value(Value::IntType{0b110000}));
+  EXPECT_EQ(Value(Value::IntType{-8}) >> Value(Value::IntType{1}), Value(Value::IntType{-4}));
+  EXPECT_EQ(a << Value(Value::IntType{64}), Value(Value::IntType{0}));
+}
+
+TEST(Value, METHOD(bitwise_operators, can_not_operate_on_numbers))
+{
+  Value i(Value::IntType{1});
+  Value n(1.0);
+  EXPECT_THROW(i & n, RuntimeError);
+  EXPECT_THROW(n | i, RuntimeError);
+  EXPECT_THROW(~n, RuntimeError);
+  EXPECT_THROW(i << Value(Value::IntType{-1}), RuntimeError);
+}
+
+TEST(Value, METHOD(concat, joins_values_like_nested_additions))
+{
+  std::vector<Value> values = {Value("a"), Value(Value::IntType{1}), Value(true), Value(0.5)};
+  EXPECT_EQ(Value::concat(values), Value("a1true0.5"));
+
+  std::vector<Value> numbers = {Value(Value::IntType{1}), Value(Value::IntType{2}), Value("b")};
+  EXPECT_EQ(Value::concat(numbers), Value("3b"));
+
+  std::vector<Value> invalid = {Value("a"), Value()};
+  EXPECT_THROW(Value::concat(invalid), RuntimeError);
+}
+
+TEST(Value, METHOD(string, copies_share_the_characters))
+{
+  Value a("some string");
+  Value b = a;
+  EXPECT_EQ(a.string_view().data(), b.string_view().data());
+  EXPECT_EQ(b.string(), "some string");
+}
+
+TEST(String, METHOD(operator_equal, compares_characters_unless_interned_in_the_same_pool))
+{
+  int pool       = 0;
+  int other_pool = 0;
+
+  ss::String a("abc", &pool);
+  ss::String b("abd", &pool);
+  ss::String c("abc", &other_pool);
+  ss::String d("abc");
+
+  EXPECT_EQ(a, a);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, c);
+  EXPECT_EQ(d, a);
+  EXPECT_TRUE(a < b);
+  EXPECT_EQ(a.hash(), d.hash());
+}
+
+TEST(String, METHOD(slice, borrows_the_characters_of_the_owner))
+{
+  auto owner = std::make_shared<ss::String>("hello world");
+  auto world = ss::String::slice(owner, 6, 100);
+  auto orl   = ss::String::slice(world, 1, 3);
+
+  EXPECT_TRUE(world->is_slice());
+  EXPECT_EQ(world->view(), "world");
+  EXPECT_EQ(world->view().data(), owner->view().data() + 6);
+  EXPECT_EQ(orl->view(), "orl");
+  EXPECT_EQ(orl->view().data(), owner->view().data() + 7);
+  EXPECT_EQ(*orl, ss::String("orl"));
+  EXPECT_EQ(orl->hash(), ss::String("orl").hash());
+  EXPECT_EQ(ss::String::slice(owner, 0, owner->size()), owner);
+  EXPECT_EQ(ss::String::slice(owner, 20, 1)->size(), 0);
+}
+
+TEST(Value, METHOD(to_string, formats_numbers_like_an_ostream))
+{
+  std::vector<Value::NumberType> numbers = {
+   0.0,
+   -0.0,
+   1.0,
+   -1.5,
+   0.1 + 0.2,
+   1.0 / 3.0,
+   123456.0,
+   1234567.0,
+   1e21,
+   1e-5,
+   0.0001,
+   6765.0,
+   9007199254740993.0,
+   std::numeric_limits<Value::NumberType>::max(),
+   std::numeric_limits<Value::NumberType>::denorm_min(),
+   std::numeric_limits<Value::NumberType>::infinity(),
+   -std::numeric_limits<Value::NumberType>::infinity(),
+   std::numeric_limits<Value::NumberType>::quiet_NaN(),
+  };
+
+  for (auto n : numbers) {
+    std::ostringstream expected;
+    expected << n;
+    EXPECT_EQ(Value(n).to_string(), expected.str());
+
+    std::ostringstream printed;
+    printed << Value(n);
+    EXPECT_EQ(printed.str(), expected.str());
+
+    EXPECT_EQ((Value("") + Value(n)).string(), expected.str());
+  }
+
+  std::ostringstream expected;
+  expected << std::numeric_limits<Value::IntType>::min();
+  EXPECT_EQ(Value(std::numeric_limits<Value::IntType>::min()).to_string(), expected.str());
+}
+
+TEST(NativeFunction, METHOD(call, passes_bound_values_after_the_arguments))
+{
+  auto concat = ss::make_ref<ss::NativeFunction>("concat", 1, [](ss::NativeFunction::Args&& args) {
+    return args[0] + args[1];
+  });
+  concat->bind(Value("bound"));
+
+  EXPECT_EQ(concat->call({Value("arg ")}), Value("arg bound"));
+}
@@ -0,0 +1,122 @@
+#include "helpers.hpp"
+#include "ss/gc.hpp"
+#include "ss/vm.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using ss::Collector;
+using ss::Function;
+using ss::make_ref;
+using ss::NativeFunction;
+using ss::Value;
+using ss::VM;
+using ss::VMConfig;
+
+namespace
+{
+  auto no_roots() -> Collector::RootSource
+  {
+    return [](const std::function<void(const Value&)>&) {};
+  }
+}  // namespace
+
+TEST(Collector, METHOD(collect, frees_released_objects_in_the_sweep))
+{
+  Collector collector(std::chrono::microseconds(0), no_roots(), no_roots());
+
+  Value kept;
+  {
+    Collector::Scope scope(collector);
+    kept = Value(make_ref<Function>("kept", 0, 0));
+    Value dropped(make_ref<Function>("dropped", 0, 0));
+  }
+
+  EXPECT_EQ(collector.stats().tracked, 2);
+
+  collector.collect();
+
+  EXPECT_EQ(collector.stats().cycles, 1);
+  EXPECT_EQ(collector.stats().freed, 1);
+  EXPECT_EQ(collector.stats().tracked, 1);
+  EXPECT_EQ(kept.function()->name, "kept");
+}
+
+TEST(Collector, METHOD(collect, only_tracks_objects_made_while_active))
+{
+  Collector collector(std::chrono::microseconds(0), no_roots(), no_roots());
+
+  auto untracked = make_ref<Function>("untracked", 0, 0);
+
+  collector.collect();
+
+  EXPECT_EQ(collector.stats().tracked, 0);
+  EXPECT_EQ(untracked.use_count(), 1);
+}
+
+TEST(Collector, METHOD(step, starts_once_enough_objects_are_made))
+{
+  Collector collector(std::chrono::microseconds(0), no_roots(), no_roots());
+  Collector::Scope scope(collector);
+
+  for (std::size_t i = 0; i < Collector::ALLOCATION_THRESHOLD; i++) {
+    EXPECT_FALSE(collector.wants_step());
+    Value v(make_ref<Function>("f", 0, 0));
+  }
+
+  EXPECT_TRUE(collector.wants_step());
+  collector.step();
+  EXPECT_FALSE(collector.wants_step());
+  EXPECT_EQ(collector.stats().freed, Collector::ALLOCATION_THRESHOLD);
+  EXPECT_EQ(collector.stats().steps, 1);
+}
+
+TEST(Collector, METHOD(collect, frees_cycles_nothing_else_refers_to))
+{
+  Collector collector(std::chrono::microseconds(0), no_roots(), no_roots());
+
+  Value held;
+  {
+    Collector::Scope scope(collector);
+    auto make_cycle = [] {
+      auto a = make_ref<NativeFunction>("a", 0, [](NativeFunction::Args&&) { return Value(); });
+      auto b = make_ref<NativeFunction>("b", 0, [](NativeFunction::Args&&) { return Value(); });
+      a->bind(Value(b));
+      b->bind(Value(a));
+      return Value(a);
+    };
+    make_cycle();
+    held = make_cycle();
+  }
+
+  collector.collect();
+
+  EXPECT_EQ(collector.stats().freed, 2);
+  EXPECT_EQ(collector.stats().freed_in_cycles, 2);
+  EXPECT_EQ(collector.stats().tracked, 2);
+
+  // what the host still holds keeps the rest of its cycle alive
+  auto b = held.native()->bound.front();
+  EXPECT_EQ(b.native()->name, "b");
+  EXPECT_EQ(b.native()->bound.front().native().get(), held.native().get());
+}
+
+TEST(VM, METHOD(collect_garbage, keeps_values_reachable_from_globals))
+{
+  std::ostringstream out;
+  VM vm(VMConfig(&std::cin, &out));
+
+  vm.run_script("fn kept() { ret 1; } fn dropped() { ret 2; } print kept();");
+  vm.set_var("dropped", Value());
+  // a new script releases the constants of the last one
+  vm.run_script("print 3;");
+
+  vm.collect_garbage();
+
+  EXPECT_EQ(vm.gc_stats().cycles, 1);
+  EXPECT_EQ(vm.gc_stats().freed, 1);
+  EXPECT_EQ(vm.gc_stats().tracked, 1);
+  EXPECT_EQ(vm.get_var("kept").function()->name, "kept");
+  EXPECT_EQ(out.str(), "1\n3\n");
+}
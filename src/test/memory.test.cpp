@@ -0,0 +1,84 @@
+#include "helpers.hpp"
+#include "ss/exceptions.hpp"
+#include "ss/memory.hpp"
+#include "ss/vm.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+
+using ss::MemoryTracker;
+using ss::RuntimeError;
+using ss::TrackingAllocator;
+using ss::Value;
+using ss::VM;
+using ss::VMConfig;
+using Category = MemoryTracker::Category;
+
+TEST(MemoryTracker, METHOD(allocate, refuses_to_go_over_the_limit))
+{
+  MemoryTracker tracker(100);
+
+  tracker.allocate(Category::STACK, 60);
+  EXPECT_THROW(tracker.allocate(Category::GLOBALS, 41), RuntimeError);
+  tracker.allocate(Category::GLOBALS, 40);
+
+  EXPECT_EQ(tracker.used(Category::STACK), 60);
+  EXPECT_EQ(tracker.used(Category::GLOBALS), 40);
+  EXPECT_EQ(tracker.total(), 100);
+
+  tracker.deallocate(Category::STACK, 60);
+  EXPECT_EQ(tracker.total(), 40);
+  EXPECT_EQ(tracker.peak(), 100);
+}
+
+TEST(TrackingAllocator, METHOD(allocate, charges_the_tracker))
+{
+  MemoryTracker tracker;
+  {
+    std::vector<int, TrackingAllocator<int, Category::CONSTANTS>> numbers(&tracker);
+    numbers.reserve(10);
+    EXPECT_EQ(tracker.used(Category::CONSTANTS), 10 * sizeof(int));
+  }
+  EXPECT_EQ(tracker.total(), 0);
+}
+
+TEST(VM, METHOD(memory_usage, counts_what_scripts_hold))
+{
+  std::ostringstream out;
+  VM vm(VMConfig(&std::cin, &out));
+
+  vm.run_script("let s = \"some characters\"; fn f() { ret s; }");
+
+  const auto& usage = vm.memory_usage();
+  EXPECT_GT(usage.used(Category::STRINGS), 0);
+  EXPECT_GT(usage.used(Category::CONSTANTS), 0);
+  EXPECT_GT(usage.used(Category::FUNCTIONS), 0);
+  EXPECT_GT(usage.used(Category::GLOBALS), 0);
+  EXPECT_GT(usage.used(Category::STACK), 0);
+}
+
+TEST(VM, METHOD(run_script, raises_a_runtime_error_past_the_memory_limit))
+{
+  std::ostringstream out;
+  VM vm(VMConfig(&std::cin, &out).set_memory_limit(64 * 1024));
+
+  EXPECT_THROW(vm.run_script("let s = \"x\"; while true { s = s + s; }"), RuntimeError);
+  EXPECT_LE(vm.memory_usage().peak(), 64 * 1024);
+}
+
+TEST(VM, METHOD(memory_usage, stays_valid_for_strings_that_outlive_the_vm))
+{
+  std::ostringstream out;
+  Value kept;
+  {
+    VM vm(VMConfig(&std::cin, &out));
+    vm.run_script("let s = \"some \" + \"characters\";");
+    kept = vm.get_var("s");
+  }
+
+  // the tracker the string is charged to goes away with it
+  EXPECT_EQ(kept, Value("some characters"));
+  kept = Value();
+}
@@ -0,0 +1,52 @@
+#include "helpers.hpp"
+#include "ss/datatypes.hpp"
+
+#include <gtest/gtest.h>
+
+using ss::Function;
+using ss::make_ref;
+using ss::Object;
+using ss::ObjectPool;
+using ss::Ref;
+using ss::Value;
+
+TEST(Ref, METHOD(copy, counts_references_in_the_object))
+{
+  auto fn = make_ref<Function>("f", 0, 0);
+  EXPECT_EQ(fn.use_count(), 1);
+  EXPECT_EQ(fn->tag(), Object::Tag::FUNCTION);
+
+  {
+    Value v(fn);
+    Value w = v;
+    EXPECT_EQ(fn.use_count(), 3);
+    EXPECT_EQ(w.function(), fn);
+  }
+
+  EXPECT_EQ(fn.use_count(), 1);
+
+  auto moved = std::move(fn);
+  EXPECT_FALSE(fn);
+  EXPECT_EQ(moved.use_count(), 1);
+}
+
+TEST(ObjectPool, METHOD(allocate, reuses_freed_blocks_of_the_same_class))
+{
+  Function* first = nullptr;
+  {
+    auto fn = make_ref<Function>("f", 0, 0);
+    first   = fn.get();
+  }
+
+  auto fn = make_ref<Function>("g", 1, 2);
+  EXPECT_EQ(fn.get(), first);
+  EXPECT_EQ(fn->name, "g");
+}
+
+TEST(ObjectPool, METHOD(class_of, groups_sizes_by_granularity))
+{
+  EXPECT_EQ(ObjectPool::class_of(1), 0);
+  EXPECT_EQ(ObjectPool::class_of(ObjectPool::GRANULARITY), 0);
+  EXPECT_EQ(ObjectPool::class_of(ObjectPool::GRANULARITY + 1), 1);
+  EXPECT_EQ(ObjectPool::class_of(ObjectPool::GRANULARITY * ObjectPool::CLASS_COUNT + 1), ObjectPool::CLASS_COUNT);
+}
@@ -0,0 +1,60 @@
+#include "ss/simd.hpp"
+
+#include "helpers.hpp"
+
+#include <gtest/gtest.h>
+
+using ss::simd::CharClass;
+using ss::simd::Isa;
+
+namespace
+{
+  constexpr Isa ALL_ISAS[] = {Isa::SCALAR, Isa::SSE2, Isa::AVX2};
+
+  /**
+   * @brief Every byte value, in runs long enough to cross a few blocks of the widest isa
+   */
+  auto sample_text() -> std::string
+  {
+    std::string text;
+    for (int c = 0; c < 256; c++) {
+      text.append(c % 70, 'a' + c % 26);
+      text.push_back(static_cast<char>(c));
+      text.append(c % 40, c % 3 == 0 ? '\n' : ' ');
+    }
+    return text;
+  }
+}  // namespace
+
+TEST(Simd, METHOD(skip, matches_the_scalar_scan_for_every_class))
+{
+  std::string text = sample_text();
+  const char* end  = text.data() + text.size();
+
+  for (auto cls : {CharClass::WHITESPACE, CharClass::IDENTIFIER, CharClass::STRING_BODY, CharClass::COMMENT}) {
+    for (auto isa : ALL_ISAS) {
+      if (!ss::simd::is_supported(isa)) {
+        continue;
+      }
+      for (const char* p = text.data(); p < end; p++) {
+        ASSERT_EQ(ss::simd::skip(cls, p, end, isa), ss::simd::skip(cls, p, end, Isa::SCALAR))
+         << "class " << static_cast<int>(cls) << " isa " << static_cast<int>(isa) << " offset " << p - text.data();
+      }
+    }
+  }
+}
+
+TEST(Simd, METHOD(count_newlines, matches_the_scalar_count))
+{
+  std::string text = sample_text();
+  const char* end  = text.data() + text.size();
+
+  for (auto isa : ALL_ISAS) {
+    if (!ss::simd::is_supported(isa)) {
+      continue;
+    }
+    for (const char* p = text.data(); p < end; p += 7) {
+      EXPECT_EQ(ss::simd::count_newlines(p, end, isa), ss::simd::count_newlines(p, end, Isa::SCALAR));
+    }
+  }
+}
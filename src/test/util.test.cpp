@@ -15,3 +15,29 @@ TEST_F(TestUtil, stream_copies_to_string)
   auto out = ss::util::stream_to_string(ss);
   EXPECT_EQ(data, out);
 }
+
+TEST_F(TestUtil, format_number_writes_into_the_buffer)
+{
+  ss::util::NumberBuffer buffer;
+  EXPECT_EQ(ss::util::format_number(2.5, buffer), "2.5");
+  EXPECT_EQ(ss::util::format_number(1e21, buffer), "1e+21");
+  EXPECT_EQ(ss::util::format_number(std::int64_t{-42}, buffer), "-42");
+}
+
+TEST_F(TestUtil, arena_serves_small_allocations_inline)
+{
+  ss::util::Arena arena;
+  std::pmr::vector<int> numbers(&arena);
+  numbers.reserve(16);
+  numbers.push_back(1);
+
+  auto addr   = reinterpret_cast<const std::byte*>(numbers.data());
+  auto object = reinterpret_cast<const std::byte*>(&arena);
+  EXPECT_GE(addr, object);
+  EXPECT_LT(addr, object + sizeof(arena));
+  EXPECT_EQ(arena.allocated(), 16 * sizeof(int));
+
+  std::pmr::vector<char> big(ss::util::Arena::INLINE_SIZE * 2, 'x', &arena);
+  EXPECT_EQ(big.back(), 'x');
+  EXPECT_EQ(arena.allocated(), 16 * sizeof(int) + ss::util::Arena::INLINE_SIZE * 2);
+}
@@ -1,8 +1,11 @@
+#include "ss/bytecode.hpp"
 #include "ss/vm.hpp"
 
 #include "helpers.hpp"
 
 #include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
 
 #define TEST_SCRIPT(src) #src
 
@@ -174,8 +177,341 @@ TEST_F(TestVM, native)
 
   std::string name = "test";
   this->vm->set_var(
-   name, Value(std::make_shared<NativeFunction>(name, 0, [](NativeFunction::Args&&) { return Value("test"); })));
+   name, Value(ss::make_ref<NativeFunction>(name, 0, [](NativeFunction::Args&&) { return Value("test"); })));
   this->vm->run_script(script);
 
   EXPECT_EQ(this->ostream->str(), "test\n");
 }
+
+TEST_F(TestVM, loop_invariants)
+{
+  const char* script = {
+#include "scripts/hoist_script.ss"
+  };
+
+  this->vm->run_script(script);
+
+  EXPECT_EQ(this->ostream->str(), "0\n1\n2\n1\n");
+}
+
+TEST_F(TestVM, typed_arithmetic)
+{
+  const char* script = {
+#include "scripts/typed_script.ss"
+  };
+
+  this->vm->run_script(script);
+
+  EXPECT_EQ(this->ostream->str(), "24\n1\n2\ndone!\n");
+}
+
+TEST_F(TestVM, loops_that_never_run_keep_the_entry_type)
+{
+  this->vm->run_script("fn f(s) { let x = s; while false { x = 1; } print x + 1; } f(\"abc\");");
+
+  EXPECT_EQ(this->ostream->str(), "abc1\n");
+}
+
+TEST_F(TestVM, register_backend)
+{
+  const char* script = {
+#include "scripts/register_script.ss"
+  };
+
+  std::ostringstream stack_out;
+  VM stack_vm(VMConfig(&std::cin, &stack_out));
+  stack_vm.run_script(script);
+
+  VM register_vm(VMConfig(&std::cin, this->ostream.get()).set_backend(VMConfig::Backend::REGISTER));
+  register_vm.run_script(script);
+
+  EXPECT_EQ(this->ostream->str(), "6\nxy\n55\ntrue\n");
+  EXPECT_EQ(this->ostream->str(), stack_out.str());
+}
+
+TEST_F(TestVM, lazy_functions)
+{
+  const char* script = {
+#include "scripts/fn_script.ss"
+  };
+
+  std::ostringstream register_out;
+  VM lazy_vm(VMConfig(&std::cin, this->ostream.get()).set_lazy_functions(true));
+  VM register_vm(VMConfig(&std::cin, &register_out).set_backend(VMConfig::Backend::REGISTER).set_lazy_functions(true));
+
+  lazy_vm.run_script(script);
+  register_vm.run_script(script);
+
+  // the body of an uncalled function is never compiled
+  lazy_vm.run_script("fn broken() { let = ; }\nfn twice(x) { ret x * 2; }\nprint twice(twice(3));");
+
+  EXPECT_EQ(this->ostream->str(), "-4\n12\n");
+  EXPECT_EQ(register_out.str(), "-4\n");
+
+  EXPECT_ANY_THROW(lazy_vm.run_script("broken();"));
+
+  try {
+    lazy_vm.run_script("fn fails(a) {\n  ret a + nil;\n}\nfails(1);", "lazy.ss");
+    FAIL() << "expected a runtime error";
+  } catch (ss::RuntimeError& e) {
+    EXPECT_EQ(std::string_view(e.what()).substr(0, 11), "lazy.ss:2 -");
+  }
+}
+
+TEST_F(TestVM, parallel_loads)
+{
+  auto dir = std::filesystem::temp_directory_path() / "ss_parallel_loads";
+  std::filesystem::create_directories(dir);
+  auto write = [&dir](const char* name, const char* src) { std::ofstream(dir / name) << src; };
+
+  const char* main = "loadr \"a.ss\";\nloadr \"b.ss\";\nprint add(base, 1);\n";
+  write("a.ss", "loadr \"c.ss\";\nlet greeting = \"a\" + name;\nprint greeting;\n");
+  write("b.ss", "let base = 40;\nfn add(x, y) {\n  ret x + y + count;\n}\n");
+  write("c.ss", "let name = \"c\";\nlet count = 0;\nfor let i = 0; i < 3; i = i + 1 {\n  count = count + 1;\n}\n");
+
+  std::ostringstream serial_out;
+  VM serial_vm(VMConfig(&std::cin, &serial_out));
+  serial_vm.run_script(main, dir / "main.ss");
+
+  VM parallel_vm(VMConfig(&std::cin, this->ostream.get()).set_module_threads(4));
+  parallel_vm.run_script(main, dir / "main.ss");
+
+  std::filesystem::remove_all(dir);
+
+  EXPECT_EQ(this->ostream->str(), "ac\n44\n");
+  EXPECT_EQ(this->ostream->str(), serial_out.str());
+}
+
+TEST_F(TestVM, compile_stats)
+{
+  auto dir = std::filesystem::temp_directory_path() / "ss_compile_stats";
+  std::filesystem::create_directories(dir);
+  auto write = [&dir](const char* name, const char* src) { std::ofstream(dir / name) << src; };
+
+  const char* main = "loadr \"a.ss\";\nloadr \"b.ss\";\nprint x + y;\n";
+  write("a.ss", "loadr \"c.ss\";\nlet x = z + 1;\n");
+  write("b.ss", "let y = 2;\n");
+  write("c.ss", "let z = 3;\n");
+
+  for (std::size_t threads : {0, 4}) {
+    std::ostringstream out;
+    VM vm(VMConfig(&std::cin, &out)
+           .set_backend(VMConfig::Backend::REGISTER)
+           .set_module_threads(threads)
+           .set_compile_stats(true));
+    vm.run_script(main, dir / "main.ss");
+    EXPECT_EQ(out.str(), "6\n");
+
+    const auto& stats = vm.compile_stats();
+    EXPECT_EQ(stats.file, (dir / "main.ss").string());
+    EXPECT_EQ(stats.bytes, std::string(main).size());
+    EXPECT_GT(stats.tokens, 0);
+    EXPECT_GT(stats.instructions, 0);
+    EXPECT_GE(stats.total, stats.scan + stats.parse + stats.load);
+
+    ASSERT_EQ(stats.modules.size(), 2);
+    EXPECT_EQ(stats.modules[0].file, (dir / "a.ss").string());
+    EXPECT_EQ(stats.modules[1].file, (dir / "b.ss").string());
+    EXPECT_GT(stats.modules[1].instructions, 0);
+    ASSERT_EQ(stats.modules[0].modules.size(), 1);
+    EXPECT_EQ(stats.modules[0].modules[0].file, (dir / "c.ss").string());
+
+    std::ostringstream report;
+    report << stats;
+    EXPECT_NE(report.str().find("c.ss"), std::string::npos);
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(TestVM, compile_cache)
+{
+  const char* script = "{\n  fn twice(x) {\n    ret x * 2;\n  }\n  print twice(count) + 1;\n}\ncount = count + 1;\n";
+  const char* other  = "print \"other\";\n";
+
+  for (bool lazy : {false, true}) {
+    std::ostringstream out;
+    VM vm(VMConfig(&std::cin, &out)
+           .set_backend(VMConfig::Backend::REGISTER)
+           .set_lazy_functions(lazy)
+           .set_compile_cache_size(1));
+    vm.set_var("count", Value(Value::IntType{1}));
+
+    vm.run_script(script);
+    vm.run_script(script);
+    vm.run_script(other);
+    vm.run_script(script);
+
+    EXPECT_EQ(out.str(), "3\n5\nother\n7\n");
+    EXPECT_EQ(vm.compile_cache().stats().hits, 1);
+    EXPECT_EQ(vm.compile_cache().stats().misses, 3);
+    EXPECT_EQ(vm.compile_cache().stats().evictions, 2);
+  }
+
+  // errors still point at the script once it comes from the cache
+  VM vm(VMConfig(&std::cin, this->ostream.get()).set_compile_cache_size(4));
+  for (int i = 0; i < 2; i++) {
+    try {
+      vm.run_script("print 1;\nprint missing;\n", "bad.ss");
+      FAIL() << "expected a runtime error";
+    } catch (ss::RuntimeError& e) {
+      EXPECT_NE(std::string(e.what()).find("bad.ss:2"), std::string::npos) << e.what();
+    }
+  }
+  EXPECT_EQ(vm.compile_cache().stats().hits, 1);
+}
+
+TEST_F(TestVM, compile_cache_notices_loaded_files_changing)
+{
+  auto dir = std::filesystem::temp_directory_path() / "ss_compile_cache_loads";
+  std::filesystem::create_directories(dir);
+  std::ofstream(dir / "lib.ss") << "print \"old\";\n";
+
+  std::ostringstream out;
+  VM vm(VMConfig(&std::cin, &out).set_compile_cache_size(4));
+  vm.run_script("loadr \"lib.ss\";\n", dir / "main.ss");
+  vm.run_script("loadr \"lib.ss\";\n", dir / "main.ss");
+
+  auto lib_time = std::filesystem::last_write_time(dir / "lib.ss");
+  std::ofstream(dir / "lib.ss") << "print \"new\";\n";
+  std::filesystem::last_write_time(dir / "lib.ss", lib_time + std::chrono::seconds(1));
+  vm.run_script("loadr \"lib.ss\";\n", dir / "main.ss");
+
+  EXPECT_EQ(out.str(), "old\nold\nnew\n");
+  EXPECT_EQ(vm.compile_cache().stats().hits, 1);
+  EXPECT_EQ(vm.compile_cache().stats().misses, 2);
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(TestVM, bytecode_files_see_globals_assigned_before_they_are_linked)
+{
+  auto dir = std::filesystem::temp_directory_path() / "ss_bytecode_globals";
+  std::filesystem::create_directories(dir);
+  auto write = [&dir](const char* name, const char* src) { std::ofstream(dir / name) << src; };
+
+  const char* main = "fn f() {\n  g = 2;\n}\nloadr \"lib.ss\";\n";
+  write("lib.ss", "let g = 1;\nlet i = 0;\nwhile i < 3 {\n  print g;\n  f();\n  i = i + 1;\n}\n");
+  ss::bytecode::compile_file((dir / "lib.ss").string(), (dir / "lib.ssc").string());
+  ASSERT_TRUE(ss::bytecode::has_fresh((dir / "lib.ss").string()));
+
+  // precompiling the loaded file must not change what the program does
+  this->vm->run_script(main, dir / "main.ss");
+  EXPECT_EQ(this->ostream->str(), "1\n2\n2\n");
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(TestVM, bytecode_files)
+{
+  auto dir = std::filesystem::temp_directory_path() / "ss_bytecode_files";
+  std::filesystem::create_directories(dir);
+  auto write = [&dir](const char* name, const char* src) { std::ofstream(dir / name) << src; };
+
+  write("main.ss", "loadr \"lib.ss\";\nprint twice(21);\n");
+  write("lib.ss", "fn twice(x) {\n  ret x * 2;\n}\nprint \"lib\";\n");
+  ss::bytecode::compile_file((dir / "main.ss").string(), (dir / "main.ssc").string());
+  ss::bytecode::compile_file((dir / "lib.ss").string(), (dir / "lib.ssc").string());
+
+  // neither the script nor what it loads needs its source once compiled
+  std::filesystem::remove(dir / "main.ss");
+  std::filesystem::remove(dir / "lib.ss");
+
+  for (auto backend : {VMConfig::Backend::STACK, VMConfig::Backend::REGISTER}) {
+    std::ostringstream out;
+    VM vm(VMConfig(&std::cin, &out).set_backend(backend));
+    vm.run_file((dir / "main.ssc").string());
+    EXPECT_EQ(out.str(), "lib\n42\n");
+  }
+
+  // a fresh compiled file is loaded in place of its source, a stale one is not
+  write("lib.ss", "fn twice(x) {\n  ret x * 2;\n}\nprint \"source\";\n");
+  auto compiled_time = std::filesystem::last_write_time(dir / "lib.ssc");
+  std::filesystem::last_write_time(dir / "lib.ss", compiled_time - std::chrono::seconds(1));
+
+  std::ostringstream fresh_out;
+  VM fresh_vm(VMConfig(&std::cin, &fresh_out));
+  fresh_vm.run_script("loadr \"lib.ss\";\n", dir / "main.ss");
+  EXPECT_EQ(fresh_out.str(), "lib\n");
+
+  std::filesystem::last_write_time(dir / "lib.ss", compiled_time + std::chrono::seconds(1));
+
+  std::ostringstream stale_out;
+  VM stale_vm(VMConfig(&std::cin, &stale_out));
+  stale_vm.run_script("loadr \"lib.ss\";\n", dir / "main.ss");
+  EXPECT_EQ(stale_out.str(), "source\n");
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(TestVM, integers)
+{
+  const char* script = {
+#include "scripts/int_script.ss"
+  };
+
+  this->vm->run_script(script);
+
+  EXPECT_EQ(this->ostream->str(), "9\n9007199254740995\n3.5\n3\n1.5\n9\n19\n-1\ntrue\n");
+}
+
+TEST_F(TestVM, concat)
+{
+  const char* script = {
+#include "scripts/concat_script.ss"
+  };
+
+  this->vm->run_script(script);
+
+  EXPECT_EQ(this->ostream->str(), "x:1:true\n3:1.5\n1-2\n");
+}
+
+TEST_F(TestVM, string_slices)
+{
+  const char* script = {
+#include "scripts/slice_script.ss"
+  };
+
+  this->vm->run_script(script);
+
+  EXPECT_EQ(this->ostream->str(), "[key = value]\nkey:value\nnil\nvalue\ntrue\n");
+}
+
+TEST_F(TestVM, native_calls)
+{
+  // arguments arrive in call order, and the caller's locals are still found afterwards
+  this->vm->run_script("fn f(a) {\n  let b = substr(\"xyz\", 1, 1);\n  ret a + b;\n}\nprint f(\"a\");\n");
+
+  EXPECT_EQ(this->ostream->str(), "ay\n");
+}
+
+TEST_F(TestVM, scripts_may_define_globals_named_like_builtins)
+{
+  this->vm->run_script("let trim = 1;\nprint trim;\n");
+  EXPECT_EQ(this->ostream->str(), "1\n");
+
+  EXPECT_THROW(this->vm->run_script("let trim = 2;\n"), ss::RuntimeError);
+}
+
+TEST_F(TestVM, runtime_errors_report_their_location)
+{
+  try {
+    this->vm->run_script("let a = 1;\nlet b = a + nil;", "errors.ss");
+    FAIL() << "expected a runtime error";
+  } catch (ss::RuntimeError& e) {
+    EXPECT_EQ(std::string_view(e.what()).substr(0, 13), "errors.ss:2 -");
+  }
+}
+
+TEST_F(TestVM, detach_debug_info)
+{
+  this->vm->run_script("fn add(a, b) { ret a + b; }\nprint add(1, 2);", "debug.ss");
+
+  EXPECT_NE(this->vm->detach_debug_info(), nullptr);
+  EXPECT_EQ(this->vm->detach_debug_info(), nullptr);
+
+  this->vm->set_var("x", Value(2.0));
+  this->vm->run_script("print x + 1;", "debug.ss");
+
+  EXPECT_EQ(this->ostream->str(), "3\n3\n");
+}